@@ -0,0 +1,89 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+/*
+Minimal benchmark harness in the spirit of Google Benchmark
+A benchmark loops over its State, the runner picks the iteration count:
+
+  void BM_Something(Bench::State& state) {
+    for (auto _ : state) { Bench::DoNotOptimize(Something()); }
+  }
+  BENCHMARK(BM_Something);
+*/
+namespace Bench {
+
+class State {
+ public:
+  class Iterator {
+   public:
+    Iterator(std::int64_t remaining) : remaining_(remaining) {}
+    bool operator!=(Iterator const&) const { return remaining_ > 0; }
+    void operator++() { --remaining_; }
+    // non trivial so "for (auto _ : state)" does not warn about an unused variable
+    struct Value {
+      Value() {}
+      ~Value() {}
+    };
+    Value operator*() const { return Value(); }
+
+   private:
+    std::int64_t remaining_;
+  };
+
+  State(std::int64_t iterations, long arg) : iterations_(iterations), arg_(arg) {}
+
+  Iterator begin() {
+    start_ = std::chrono::steady_clock::now();
+    return Iterator(iterations_);
+  }
+  Iterator end() { return Iterator(0); }
+
+  // argument the benchmark was registered with
+  long range() const { return arg_; }
+  std::int64_t iterations() const { return iterations_; }
+
+  // attach extra output to the result line (e.g. syscall counts)
+  void SetLabel(std::string label) { label_ = std::move(label); }
+  std::string const& Label() const { return label_; }
+  // exclude setup inside the loop from the timing
+  void PauseTiming();
+  void ResumeTiming();
+  std::chrono::nanoseconds Elapsed() const;
+
+ private:
+  std::int64_t iterations_;
+  long arg_;
+  std::string label_;
+  std::chrono::steady_clock::time_point start_;
+  std::chrono::steady_clock::time_point paused_;
+  std::chrono::nanoseconds excluded_{0};
+};
+
+using Function = std::function<void(State&)>;
+
+// register a benchmark once per argument, returns true so it can initialize a static
+bool Register(std::string const& name, Function function, std::vector<long> args = {0});
+
+// keep the compiler from dropping a computed value
+template <typename T>
+inline void DoNotOptimize(T const& value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+};  // namespace Bench
+
+#define BENCH_CONCAT_(a, b) a##b
+#define BENCH_CONCAT(a, b) BENCH_CONCAT_(a, b)
+#define BENCHMARK(function) \
+  static bool BENCH_CONCAT(bench_registered_, __LINE__) = Bench::Register(#function, function)
+#define BENCHMARK_ARGS(function, ...)                                       \
+  static bool BENCH_CONCAT(bench_registered_, __LINE__) = Bench::Register( \
+      #function, function, {__VA_ARGS__})
+
+#endif
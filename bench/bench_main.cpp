@@ -0,0 +1,83 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "bench.h"
+#include "fake_proc.h"
+
+using std::string;
+using std::vector;
+
+namespace {
+struct Benchmark {
+  string name;
+  Bench::Function function;
+  long arg;
+};
+
+vector<Benchmark>& Registry() {
+  static vector<Benchmark> registry;
+  return registry;
+}
+
+// run with a growing iteration count until the loop takes long enough
+double Run(Benchmark const& benchmark, double min_seconds, string& label) {
+  std::int64_t iterations = 1;
+  while (true) {
+    Bench::State state(iterations, benchmark.arg);
+    benchmark.function(state);
+    double seconds = std::chrono::duration<double>(state.Elapsed()).count();
+    if (seconds >= min_seconds || iterations >= (1LL << 30)) {
+      label = state.Label();
+      return seconds * 1e9 / iterations;
+    }
+    std::int64_t next = seconds > 0 ? std::int64_t(iterations * min_seconds * 1.4 / seconds) : iterations * 10;
+    iterations = std::max(iterations * 2, std::min(next, iterations * 100));
+  }
+}
+}  // namespace
+
+void Bench::State::PauseTiming() { paused_ = std::chrono::steady_clock::now(); }
+
+void Bench::State::ResumeTiming() { excluded_ += std::chrono::steady_clock::now() - paused_; }
+
+std::chrono::nanoseconds Bench::State::Elapsed() const {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now() - start_ - excluded_);
+}
+
+bool Bench::Register(string const& name, Function function, vector<long> args) {
+  for (long arg : args) {
+    string full = args.size() > 1 || arg != 0 ? name + "/" + std::to_string(arg) : name;
+    Registry().push_back({full, function, arg});
+  }
+  return true;
+}
+
+// usage: monitor_bench [--min-time=<seconds>] [filter]
+//        monitor_bench --generate=<processes>  write a fake /proc tree and print its path
+int main(int argc, char* argv[]) {
+  double min_seconds = 0.2;
+  string filter;
+  for (int i = 1; i < argc; ++i) {
+    if (std::strncmp(argv[i], "--min-time=", 11) == 0) {
+      min_seconds = std::stod(argv[i] + 11);
+    } else if (std::strncmp(argv[i], "--generate=", 11) == 0) {
+      std::printf("%s\n", FakeProc::Tree(std::stoi(argv[i] + 11)).c_str());
+      return 0;
+    } else {
+      filter = argv[i];
+    }
+  }
+
+  std::printf("%-48s %16s\n", "Benchmark", "Time/op");
+  for (Benchmark const& benchmark : Registry()) {
+    if (!filter.empty() && benchmark.name.find(filter) == string::npos) { continue; }
+    string label;
+    double ns = Run(benchmark, min_seconds, label);
+    std::printf("%-48s %13.0f ns  %s\n", benchmark.name.c_str(), ns, label.c_str());
+    std::fflush(stdout);
+  }
+}
@@ -0,0 +1,200 @@
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <utility>
+#include <string>
+#include <string_view>
+
+#include "fake_proc.h"
+#include "linux_parser.h"
+
+using std::string;
+using namespace std::string_view_literals;
+
+namespace {
+
+// bump when the generated files change, older trees are regenerated
+const int kVersion{2};
+const double kUptime{86400.0};
+const long kHertz{100};
+
+struct Program {
+  const char* name;
+  std::string_view cmdline;  // arguments terminated by NUL, empty for kernel threads
+};
+
+const Program kPrograms[] = {
+    {"bash", "-bash\0"sv},
+    {"python3", "/usr/bin/python3\0-m\0worker\0--queue\0default\0"sv},
+    {"nginx", "nginx: worker process\0"sv},
+    {"postgres", "postgres: checkpointer\0"sv},
+    {"java", "/usr/lib/jvm/java-17/bin/java\0-Xmx4g\0-jar\0/opt/service/service.jar\0"sv},
+    {"node", "node\0/srv/app/server.js\0--port\0" "8080\0"sv},
+    {"sshd", "sshd: user@pts/0\0"sv},
+    {"kworker/0:1", ""sv},
+};
+const int kUids[] = {0, 0, 1000, 33, 999, 65534};
+
+// small deterministic hash of the pid for all "random" values
+unsigned long Mix(unsigned long value) {
+  value ^= value >> 33;
+  value *= 0xff51afd7ed558ccdUL;
+  value ^= value >> 33;
+  return value;
+}
+
+bool Write(string const& path, string const& text) {
+  std::FILE* file = std::fopen(path.c_str(), "w");
+  if (file == nullptr) { return false; }
+  bool written = std::fwrite(text.data(), 1, text.size(), file) == text.size();
+  return std::fclose(file) == 0 && written;
+}
+
+string Format(const char* format, ...) __attribute__((format(printf, 1, 2)));
+string Format(const char* format, ...) {
+  char buffer[4096];
+  va_list args;
+  va_start(args, format);
+  int length = std::vsnprintf(buffer, sizeof(buffer), format, args);
+  va_end(args);
+  return string(buffer, length < 0 ? 0 : std::min(length, int(sizeof(buffer) - 1)));
+}
+
+}  // namespace
+
+// Every second of a tick adds kHertz jiffies per core, split by a per core load
+bool FakeProc::WriteStat(string const& root, int processes, int cores, int tick) {
+  unsigned long long busy = kUptime * kHertz * 0.2, idle = kUptime * kHertz * 0.8;
+  string stat = Format("cpu  %llu 120 %llu %llu 300 0 80 0 0 0\n", busy * cores * 3 / 4, busy * cores / 4,
+                       idle * cores + (unsigned long long)(tick) * kHertz * cores);
+  for (int core = 0; core < cores; ++core) {
+    unsigned long long load = tick * (Mix(core) % (kHertz + 1));
+    stat += Format("cpu%d %llu 15 %llu %llu 37 0 10 0 0 0\n", core, busy * 3 / 4 + load * 3 / 4,
+                   busy / 4 + load - load * 3 / 4, idle + tick * kHertz - load);
+  }
+  stat += Format("intr 123456789 0 9 0 0 0 0 0 0 0 0 0 0 0\nctxt 987654321\nbtime 1700000000\n"
+                 "processes %d\nprocs_running %d\nprocs_blocked 0\n"
+                 "softirq 23456789 0 1234 5 678 90 0 12 3456 0 7890\n",
+                 processes * 4, 1 + processes / 100);
+  return Write(root + "stat", stat);
+}
+
+namespace {
+
+bool WriteSystem(string const& root, int processes, int cores) {
+  string meminfo = Format(
+      "MemTotal:       32768000 kB\nMemFree:         8192000 kB\nMemAvailable:   20480000 kB\n"
+      "Buffers:          512000 kB\nCached:         10240000 kB\nSwapCached:             0 kB\n"
+      "Active:         12000000 kB\nInactive:        9000000 kB\nSwapTotal:       8388604 kB\n"
+      "SwapFree:        8388604 kB\nDirty:               256 kB\nAnonPages:      %ld kB\n"
+      "Mapped:           900000 kB\nShmem:            300000 kB\nSlab:             800000 kB\n"
+      "SReclaimable:     600000 kB\nSUnreclaim:       200000 kB\nPageTables:        90000 kB\n"
+      "CommitLimit:   24772604 kB\nCommitted_AS:  30000000 kB\nVmallocTotal:   34359738367 kB\n",
+      long(processes) * 4096);
+  if (mkdir((root + "net").c_str(), 0755) != 0 && errno != EEXIST) { return false; }
+
+  return FakeProc::WriteStat(root, processes, cores) && Write(root + "meminfo", meminfo) &&
+         Write(root + "diskstats",
+               "   8       0 sda 81234 2345 9876543 45678 123456 34567 23456789 234567 0 98765 280245 0 0 0 0\n"
+               "   8       1 sda1 81000 2345 9870000 45600 123400 34567 23456000 234500 0 98700 280100 0 0 0 0\n"
+               " 259       0 nvme0n1 456789 0 87654321 123456 345678 0 98765432 345678 0 234567 469134 0 0 0 0\n"
+               " 259       1 nvme0n1p1 456700 0 87650000 123400 345600 0 98765000 345600 0 234500 469000 0 0 0 0\n"
+               "   7       0 loop0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0\n") &&
+         Write(root + "net/dev",
+               "Inter-|   Receive                                                |  Transmit\n"
+               " face |bytes    packets errs drop fifo frame compressed multicast|bytes    packets errs drop fifo "
+               "colls carrier compressed\n"
+               "    lo: 75071331    9541    0    0    0     0          0         0 75071331    9541    0    0    0"
+               "     0       0          0\n"
+               "  eth0: 9876543210 6543210    0    0    0     0          0         0 1234567890 3456789    0    0"
+               "    0     0       0          0\n") &&
+         Write(root + "uptime", Format("%.2f %.2f\n", kUptime, kUptime * cores * 0.8)) &&
+         Write(root + "version", "Linux version 6.1.0-fake (bench@monitor) (gcc 12.2.0) #1 SMP\n");
+}
+
+// stat, status, io and cmdline like the kernel writes them, see proc(5)
+bool WriteProcess(string const& root, int pid) {
+  unsigned long hash = Mix(pid);
+  Program const& program = kPrograms[hash % (sizeof(kPrograms) / sizeof(kPrograms[0]))];
+  int uid = kUids[(hash >> 8) % (sizeof(kUids) / sizeof(kUids[0]))];
+  unsigned long long start = (hash >> 16) % (long(kUptime) * kHertz);
+  unsigned long long utime = (hash >> 24) % (start / 10 + 1), stime = utime / 3;
+  long threads = 1 + (hash >> 40) % 16;
+  long rss_pages = 100 + (hash >> 20) % 50000;
+  char state = (hash >> 12) % 50 == 0 ? 'R' : 'S';
+
+  string directory = root + std::to_string(pid) + "/";
+  if (mkdir(directory.c_str(), 0755) != 0 && errno != EEXIST) { return false; }
+
+  string stat = Format("%d (%s) %c %d %d %d 0 -1 4194560 %lu 0 %lu 0 %llu %llu 0 0 20 0 %ld 0 %llu %llu %ld "
+                       "18446744073709551615 1 1 0 0 0 0 0 0 0 0 0 0 17 %d 0 0 0 0 0 0 0 0 0 0 0 0 0\n",
+                       pid, program.name, state, pid > 1 ? 1 : 0, pid, pid, hash % 10000, hash % 100,
+                       utime, stime, threads, start, rss_pages * 4096ULL * 3, rss_pages, pid % 8);
+  string status = Format(
+      "Name:\t%s\nUmask:\t0022\nState:\t%c (%s)\nTgid:\t%d\nNgid:\t0\nPid:\t%d\nPPid:\t%d\n"
+      "TracerPid:\t0\nUid:\t%d\t%d\t%d\t%d\nGid:\t%d\t%d\t%d\t%d\nFDSize:\t64\nGroups:\t%d\n"
+      "NStgid:\t%d\nNSpid:\t%d\nNSpgid:\t%d\nNSsid:\t%d\nVmPeak:\t%8ld kB\nVmSize:\t%8ld kB\n"
+      "VmLck:\t       0 kB\nVmPin:\t       0 kB\nVmHWM:\t%8ld kB\nVmRSS:\t%8ld kB\n"
+      "RssAnon:\t%8ld kB\nRssFile:\t%8ld kB\nRssShmem:\t       0 kB\nVmData:\t%8ld kB\n"
+      "VmStk:\t     132 kB\nVmExe:\t     900 kB\nVmLib:\t    4000 kB\nVmPTE:\t     120 kB\n"
+      "VmSwap:\t       0 kB\nHugetlbPages:\t       0 kB\nCoreDumping:\t0\nTHP_enabled:\t1\n"
+      "Threads:\t%ld\nSigQ:\t0/127431\nSigPnd:\t0000000000000000\nShdPnd:\t0000000000000000\n"
+      "SigBlk:\t0000000000000000\nSigIgn:\t0000000000001000\nSigCgt:\t0000000180004002\n"
+      "CapInh:\t0000000000000000\nCapPrm:\t0000000000000000\nCapEff:\t0000000000000000\n"
+      "CapBnd:\t000001ffffffffff\nCapAmb:\t0000000000000000\nNoNewPrivs:\t0\nSeccomp:\t0\n"
+      "Speculation_Store_Bypass:\tthread vulnerable\nCpus_allowed:\tff\nCpus_allowed_list:\t0-7\n"
+      "Mems_allowed:\t00000001\nMems_allowed_list:\t0\nvoluntary_ctxt_switches:\t%lu\n"
+      "nonvoluntary_ctxt_switches:\t%lu\n",
+      program.name, state, state == 'R' ? "running" : "sleeping", pid, pid, pid > 1 ? 1 : 0, uid, uid, uid,
+      uid, uid, uid, uid, uid, uid, pid, pid, pid, pid, rss_pages * 12, rss_pages * 12, rss_pages * 4,
+      rss_pages * 4, rss_pages * 3, rss_pages, rss_pages * 6, threads, hash % 100000, hash % 1000);
+
+  unsigned long long read = (hash >> 28) % 100000000, written = (hash >> 36) % 10000000;
+  string io = Format("rchar: %llu\nwchar: %llu\nsyscr: %llu\nsyscw: %llu\nread_bytes: %llu\nwrite_bytes: %llu\n"
+                     "cancelled_write_bytes: 0\n",
+                     read * 3, written * 2, read / 4096 + 10, written / 4096 + 5, read, written);
+
+  return Write(directory + "stat", stat) && Write(directory + "status", status) && Write(directory + "io", io) &&
+         Write(directory + "cmdline", string(program.cmdline));
+}
+
+}  // namespace
+
+bool FakeProc::Generate(string const& root, int processes, int cores) {
+  string directory = root.back() == '/' ? root : root + "/";
+  if (mkdir(directory.c_str(), 0755) != 0 && errno != EEXIST) { return false; }
+  if (!WriteSystem(directory, processes, cores)) { return false; }
+  for (int pid = 1; pid <= processes; ++pid) {
+    if (!WriteProcess(directory, pid)) { return false; }
+  }
+  return Write(directory + "generated", std::to_string(kVersion) + "\n");
+}
+
+string const& FakeProc::Tree(int processes, int cores) {
+  static std::map<std::pair<int, int>, string> trees;
+  auto found = trees.find({processes, cores});
+  if (found != trees.end()) { return found->second; }
+
+  const char* temp = std::getenv("TMPDIR");
+  string root = string(temp ? temp : "/tmp") + "/monitor_fake_proc_" + std::to_string(processes) +
+                (cores == 8 ? "" : "_" + std::to_string(cores) + "cores") + "/";
+  std::ifstream marker(root + "generated");
+  int version{0};
+  if (!(marker >> version) || version != kVersion) {
+    std::fprintf(stderr, "generating %s\n", root.c_str());
+    if (!Generate(root, processes, cores)) { std::perror(root.c_str()); }
+  }
+  return trees.emplace(std::make_pair(processes, cores), root).first->second;
+}
+
+FakeProc::Root::Root(string const& root) : previous_(LinuxParser::ProcDirectory()) {
+  LinuxParser::SetProcDirectory(root);
+}
+
+FakeProc::Root::~Root() { LinuxParser::SetProcDirectory(previous_); }
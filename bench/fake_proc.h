@@ -0,0 +1,36 @@
+#ifndef FAKE_PROC_H
+#define FAKE_PROC_H
+
+#include <string>
+
+/*
+Synthetic /proc trees for reproducible benchmarks
+A tree has the system wide files (stat, meminfo, uptime, version,
+diskstats, net/dev) and stat, status, io and cmdline for the pids 1 to n. All values are derived from
+the pid, so the same size always gives the same tree
+*/
+namespace FakeProc {
+//write a tree with the given number of processes and cores below root
+bool Generate(std::string const& root, int processes, int cores = 8);
+
+//rewrite the stat file of a tree as it reads tick seconds later, root ends in '/'
+bool WriteStat(std::string const& root, int processes, int cores, int tick = 0);
+
+//tree with the given number of processes and cores in the temp directory,
+//generated on first use and kept for later runs
+std::string const& Tree(int processes, int cores = 8);
+
+//point LinuxParser at a tree while in scope
+class Root {
+ public:
+  explicit Root(std::string const& root);
+  ~Root();
+  Root(Root const&) = delete;
+  Root& operator=(Root const&) = delete;
+
+ private:
+  std::string previous_;
+};
+};  // namespace FakeProc
+
+#endif
@@ -0,0 +1,108 @@
+#include <vector>
+
+#include "bench.h"
+#include "fake_proc.h"
+#include "linux_parser.h"
+#include "processor.h"
+#include "syscall_counter.h"
+#include "system.h"
+#include "system_snapshot.h"
+
+// The scan against generated /proc trees of 1k, 10k and 100k processes,
+// so the numbers do not depend on what the machine happens to run
+
+void BM_FakePids(Bench::State& state) {
+  FakeProc::Root root(FakeProc::Tree(state.range()));
+  for (auto _ : state) {
+    std::vector<int> pids = LinuxParser::Pids();
+    Bench::DoNotOptimize(pids.size());
+  }
+}
+BENCHMARK_ARGS(BM_FakePids, 1000, 10000, 100000);
+
+// every process is new: stat, status and cmdline are read and the rows added
+void BM_FakeProcessConstruction(Bench::State& state) {
+  FakeProc::Root root(FakeProc::Tree(state.range()));
+  for (auto _ : state) {
+    System system;
+    Bench::DoNotOptimize(system.Processes().Size());
+  }
+}
+BENCHMARK_ARGS(BM_FakeProcessConstruction, 1000, 10000, 100000);
+
+// steady state: a refresh of known processes
+// the label counts the syscalls per refresh, like strace -c
+void BM_FakeSystemProcesses(Bench::State& state) {
+  FakeProc::Root root(FakeProc::Tree(state.range()));
+  System system(1, false, 0.0, 0, state.range());
+  SyscallCounter syscalls;
+  for (auto _ : state) {
+    system.Refresh();
+    Bench::DoNotOptimize(system.Processes().Size());
+  }
+  state.SetLabel(syscalls.Label(state.iterations()));
+}
+BENCHMARK_ARGS(BM_FakeSystemProcesses, 1000, 10000, 100000);
+
+// the same without descriptors kept open: an open and a close per file read
+void BM_FakeSystemProcessesUncached(Bench::State& state) {
+  FakeProc::Root root(FakeProc::Tree(state.range()));
+  System system(1, false, 0.0, 0, 0);
+  SyscallCounter syscalls;
+  for (auto _ : state) {
+    system.Refresh();
+    Bench::DoNotOptimize(system.Processes().Size());
+  }
+  state.SetLabel(syscalls.Label(state.iterations()));
+}
+BENCHMARK_ARGS(BM_FakeSystemProcessesUncached, 1000, 10000, 100000);
+
+// the stat and io files read in batches through io_uring, descriptors kept
+// open as in BM_FakeSystemProcesses; the same as that one if the ring is unavailable
+void BM_FakeSystemProcessesUring(Bench::State& state) {
+  FakeProc::Root root(FakeProc::Tree(state.range()));
+  System system(1, false, 0.0, 0, state.range(), true);
+  SyscallCounter syscalls;
+  for (auto _ : state) {
+    system.Refresh();
+    Bench::DoNotOptimize(system.Processes().Size());
+  }
+  state.SetLabel(syscalls.Label(state.iterations()));
+}
+BENCHMARK_ARGS(BM_FakeSystemProcessesUring, 1000, 10000, 100000);
+
+// /proc/stat with 8 cores, parsed and turned into utilizations
+void BM_FakeProcessorUtilization(Bench::State& state) {
+  FakeProc::Root root(FakeProc::Tree(1000));
+  SystemSnapshot snapshot;
+  Processor cpu;
+  for (auto _ : state) {
+    snapshot.Refresh();
+    cpu.Update(snapshot);
+    Bench::DoNotOptimize(cpu.Utilization());
+  }
+}
+BENCHMARK(BM_FakeProcessorUtilization);
+
+// /proc/stat with 8 to 256 cores, the per core part of the utilization alone
+// over snapshots a second apart, every 8th update steps back to the first
+void BM_FakeCoreUtilization(Bench::State& state) {
+  const int kTicks{8};
+  int cores = int(state.range());
+  std::string const& tree = FakeProc::Tree(16, cores);
+  FakeProc::Root root(tree);
+  std::vector<SystemSnapshot> snapshots(kTicks);
+  for (int tick = 0; tick < kTicks; ++tick) {
+    FakeProc::WriteStat(tree, 16, cores, tick + 1);
+    snapshots[tick].Refresh();
+  }
+  FakeProc::WriteStat(tree, 16, cores);
+  Processor cpu;
+  int tick{0};
+  for (auto _ : state) {
+    cpu.Update(snapshots[tick]);
+    tick = (tick + 1) % kTicks;
+    Bench::DoNotOptimize(cpu.CoreUtilization().data());
+  }
+}
+BENCHMARK_ARGS(BM_FakeCoreUtilization, 8, 64, 256);
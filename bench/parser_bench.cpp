@@ -0,0 +1,187 @@
+#include <stdlib.h>
+#include <unistd.h>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "bench.h"
+#include "proc_parser.h"
+
+using std::string;
+using std::vector;
+
+// Compare the ifstream/istringstream parsing the monitor used to do
+// with ProcParser on files captured once from the running system
+namespace {
+
+// copy /proc/self/stat, /proc/self/status and /proc/meminfo into a temp dir
+// so both parsers see identical, stable input
+struct CapturedFiles {
+  string directory;
+  string stat;
+  string status;
+  string meminfo;
+
+  CapturedFiles() {
+    char dir[] = "/tmp/monitor_bench_XXXXXX";
+    directory = mkdtemp(dir) ? dir : "/tmp";
+    stat = Capture("/proc/self/stat", "stat");
+    status = Capture("/proc/self/status", "status");
+    meminfo = Capture("/proc/meminfo", "meminfo");
+  }
+
+  string Capture(string const& source, string const& name) {
+    string target = directory + "/" + name;
+    std::ifstream in(source);
+    std::ofstream out(target);
+    out << in.rdbuf();
+    return target;
+  }
+};
+
+CapturedFiles const& Files() {
+  static CapturedFiles files;
+  return files;
+}
+
+bool is_number(const string& s) {
+  string::const_iterator it = s.begin();
+  while (it != s.end() && std::isdigit(*it)) ++it;
+  return !s.empty() && it == s.end();
+}
+
+// the former LinuxParser findValueByKey
+template <typename T>
+T LegacyFindValueByKey(string const& keyFilter, string const& file) {
+  string line, key;
+  T value{};
+  std::ifstream stream(file);
+  if (stream.is_open()) {
+    while (std::getline(stream, line)) {
+      std::istringstream linestream(line);
+      while (linestream >> key >> value) {
+        if (key == keyFilter) { return value; }
+      }
+    }
+  }
+  return value;
+}
+
+// the former LinuxParser::CpuUtilization(pid) plus the Process conversion
+float LegacyStatTimes(string const& file) {
+  vector<string> times{};
+  std::ifstream filestream(file);
+  if (filestream.is_open()) {
+    for (string time; filestream >> time; times.emplace_back(time));
+  }
+  float total{0};
+  if (times.size() > 21 && is_number(times[13]) && is_number(times[14]) &&
+      is_number(times[15]) && is_number(times[16]) && is_number(times[21])) {
+    total = stof(times[13]) + stof(times[14]) + stof(times[15]) + stof(times[16]) + stof(times[21]);
+  }
+  return total;
+}
+
+void BM_LegacyPidStat(Bench::State& state) {
+  string const& file = Files().stat;
+  for (auto _ : state) { Bench::DoNotOptimize(LegacyStatTimes(file)); }
+}
+BENCHMARK(BM_LegacyPidStat);
+
+void BM_ProcParserPidStat(Bench::State& state) {
+  string const& file = Files().stat;
+  ProcParser::Buffer buffer;
+  for (auto _ : state) {
+    ProcParser::PidStat stat;
+    ProcParser::ReadFile(file.c_str(), buffer);
+    ProcParser::ParsePidStat(buffer.View(), stat);
+    Bench::DoNotOptimize(stat);
+  }
+}
+BENCHMARK(BM_ProcParserPidStat);
+
+void BM_LegacyStatusVmRSS(Bench::State& state) {
+  string const& file = Files().status;
+  for (auto _ : state) { Bench::DoNotOptimize(LegacyFindValueByKey<double>("VmRSS:", file)); }
+}
+BENCHMARK(BM_LegacyStatusVmRSS);
+
+void BM_ProcParserStatusVmRSS(Bench::State& state) {
+  string const& file = Files().status;
+  ProcParser::Buffer buffer;
+  for (auto _ : state) {
+    double rss{0};
+    ProcParser::ReadFile(file.c_str(), buffer);
+    ProcParser::FindValue(buffer.View(), "VmRSS:", rss);
+    Bench::DoNotOptimize(rss);
+  }
+}
+BENCHMARK(BM_ProcParserStatusVmRSS);
+
+// four separate scans, as MemoryUtilization used to do
+void BM_LegacyMeminfo(Bench::State& state) {
+  string const& file = Files().meminfo;
+  for (auto _ : state) {
+    float total = LegacyFindValueByKey<float>("MemTotal:", file);
+    float free = LegacyFindValueByKey<float>("MemFree:", file);
+    float buffers = LegacyFindValueByKey<float>("Buffers:", file);
+    float cached = LegacyFindValueByKey<float>("Cached:", file);
+    Bench::DoNotOptimize(total - free - buffers - cached);
+  }
+}
+BENCHMARK(BM_LegacyMeminfo);
+
+void BM_ProcParserMeminfo(Bench::State& state) {
+  string const& file = Files().meminfo;
+  ProcParser::Buffer buffer;
+  for (auto _ : state) {
+    float total{0}, free{0}, buffers{0}, cached{0};
+    ProcParser::ReadFile(file.c_str(), buffer);
+    std::string_view text = buffer.View();
+    ProcParser::FindValue(text, "MemTotal:", total);
+    ProcParser::FindValue(text, "MemFree:", free);
+    ProcParser::FindValue(text, "Buffers:", buffers);
+    ProcParser::FindValue(text, "Cached:", cached);
+    Bench::DoNotOptimize(total - free - buffers - cached);
+  }
+}
+BENCHMARK(BM_ProcParserMeminfo);
+
+// smaps_rollup is generated by walking every mapping of the process, read
+// live since that walk is the cost, against the live status file
+void BM_LiveStatusVmRSS(Bench::State& state) {
+  ProcParser::Buffer buffer;
+  for (auto _ : state) {
+    long rss{0};
+    ProcParser::ReadFile("/proc/self/status", buffer);
+    ProcParser::FindValue(buffer.View(), "VmRSS:", rss);
+    Bench::DoNotOptimize(rss);
+  }
+}
+BENCHMARK(BM_LiveStatusVmRSS);
+
+void BM_LiveSmapsRollup(Bench::State& state) {
+  ProcParser::Buffer buffer;
+  for (auto _ : state) {
+    long pss{0};
+    ProcParser::ReadFile("/proc/self/smaps_rollup", buffer);
+    ProcParser::FindValue(buffer.View(), "Pss:", pss);
+    Bench::DoNotOptimize(pss);
+  }
+}
+BENCHMARK(BM_LiveSmapsRollup);
+
+// the io file read next to stat when a process ran
+void BM_LivePidIo(Bench::State& state) {
+  ProcParser::Buffer buffer;
+  for (auto _ : state) {
+    ProcParser::PidIo io;
+    ProcParser::ReadFile("/proc/self/io", buffer);
+    ProcParser::ParsePidIo(buffer.View(), io);
+    Bench::DoNotOptimize(io.write_bytes);
+  }
+}
+BENCHMARK(BM_LivePidIo);
+
+}  // namespace
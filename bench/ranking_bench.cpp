@@ -0,0 +1,235 @@
+#include <algorithm>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "bench.h"
+#include "delta_counter.h"
+#include "format.h"
+#include "process_filter.h"
+#include "process_table.h"
+#include "ranking.h"
+#include "system.h"
+
+// Scans over 50k processes: the vector of Process objects used before
+// (every process a fat object with its strings) versus the ProcessTable
+// columns. Both hold the same rows, copied from this machine until
+// there are 50k of them
+namespace {
+
+const std::size_t kProcesses{50000};
+
+// the layout of a Process before the table
+struct LegacyProcess {
+  int pid;
+  int uid;
+  std::string user;
+  std::string command;
+  float cpu;
+  std::string ram;
+  long ram_kb;
+  long uptime;
+  long long start_time;
+  DeltaCounter cpu_time;
+
+  bool operator<(LegacyProcess const& a) const { return a.cpu < cpu; }
+};
+
+ProcessTable const& Table() {
+  static ProcessTable table = [] {
+    System system;
+    ProcessTable const& processes = system.Processes();
+    ProcessTable all;
+    while (all.Size() < kProcesses) {
+      for (std::size_t i = 0; i < processes.Size() && all.Size() < kProcesses; ++i) {
+        std::size_t row = all.Add(processes.pid[i], processes.uid[i], processes.User(i), processes.Command(i));
+        all.cpu[row] = processes.cpu[i] + row * 1e-9f;
+        all.rss_kb[row] = processes.rss_kb[i];
+        all.uptime[row] = processes.uptime[i];
+        all.start_time[row] = processes.start_time[i];
+      }
+    }
+    all.Index();
+    return all;
+  }();
+  return table;
+}
+
+std::vector<LegacyProcess> const& Legacy() {
+  static std::vector<LegacyProcess> legacy = [] {
+    ProcessTable const& table = Table();
+    std::vector<LegacyProcess> all;
+    for (std::size_t i = 0; i < table.Size(); ++i) {
+      all.push_back({table.pid[i], table.uid[i], std::string(table.User(i)),
+                     std::string(table.Command(i)), table.cpu[i], Format::Megabytes(table.rss_kb[i]),
+                     table.rss_kb[i], table.uptime[i], (long long)table.start_time[i], {}});
+    }
+    return all;
+  }();
+  return legacy;
+}
+
+// the uid owning the most memory is filtered for
+int BusyUid() {
+  std::vector<long> const& rss_kb = Table().rss_kb;
+  return Table().uid[std::max_element(rss_kb.begin(), rss_kb.end()) - rss_kb.begin()];
+}
+
+}  // namespace
+
+// Top 10 by CPU
+void BM_FullSort(Bench::State& state) {
+  std::vector<LegacyProcess> processes;
+  for (auto _ : state) {
+    state.PauseTiming();
+    processes = Legacy();
+    state.ResumeTiming();
+    std::sort(processes.begin(), processes.end());
+    Bench::DoNotOptimize(processes.front().pid);
+  }
+}
+BENCHMARK(BM_FullSort);
+
+void BM_LegacyTop(Bench::State& state) {
+  std::vector<std::pair<float, std::uint32_t>> entries;
+  for (auto _ : state) {
+    std::vector<LegacyProcess> const& processes = Legacy();
+    entries.resize(processes.size());
+    for (std::size_t i = 0; i < processes.size(); ++i) { entries[i] = {processes[i].cpu, std::uint32_t(i)}; }
+    std::nth_element(entries.begin(), entries.begin() + 10, entries.end(), std::greater<>());
+    Bench::DoNotOptimize(entries.front());
+  }
+}
+BENCHMARK(BM_LegacyTop);
+
+void BM_RankingTop(Bench::State& state) {
+  std::vector<std::size_t> top;
+  for (auto _ : state) {
+    Ranking::Top(Table(), Ranking::Key::kCpu, 10, top);
+    Bench::DoNotOptimize(top.front());
+  }
+}
+BENCHMARK(BM_RankingTop);
+
+// Ten rows by CPU from the middle of the order, as after a jump to a pid
+void BM_RankingPage(Bench::State& state) {
+  std::vector<std::size_t> page;
+  for (auto _ : state) {
+    Ranking::Page(Table(), Ranking::Key::kCpu, Table().ByPid(), kProcesses / 2, 10, page);
+    Bench::DoNotOptimize(page.front());
+  }
+}
+BENCHMARK(BM_RankingPage);
+
+// Where a pid is in the order by CPU
+void BM_RankingPosition(Bench::State& state) {
+  std::size_t row = Table().Find(Table().pid[kProcesses / 2]);
+  for (auto _ : state) {
+    Bench::DoNotOptimize(Ranking::Position(Table(), Ranking::Key::kCpu, Table().ByPid(), row));
+  }
+}
+BENCHMARK(BM_RankingPosition);
+
+// 1% new rows merged into the orders, as a tick adds them
+void BM_TableIndex(Bench::State& state) {
+  ProcessTable processes;
+  for (auto _ : state) {
+    state.PauseTiming();
+    processes.Assign(Table());
+    for (std::size_t i = 0; i < kProcesses / 100; ++i) {
+      processes.Add(Table().pid[i] + 1, Table().uid[i], Table().User(i), Table().Command(i));
+    }
+    state.ResumeTiming();
+    processes.Index();
+    Bench::DoNotOptimize(processes.ByUser().data());
+  }
+}
+BENCHMARK(BM_TableIndex);
+
+// Processes of one user above 1% CPU
+void BM_LegacyFilter(Bench::State& state) {
+  int uid = BusyUid();
+  for (auto _ : state) {
+    long count{0};
+    for (LegacyProcess const& process : Legacy()) { count += process.uid == uid && process.cpu > 0.01f; }
+    Bench::DoNotOptimize(count);
+  }
+}
+BENCHMARK(BM_LegacyFilter);
+
+void BM_TableFilter(Bench::State& state) {
+  int uid = BusyUid();
+  for (auto _ : state) {
+    ProcessTable const& table = Table();
+    long count{0};
+    for (std::size_t i = 0; i < table.Size(); ++i) { count += table.uid[i] == uid && table.cpu[i] > 0.01f; }
+    Bench::DoNotOptimize(count);
+  }
+}
+BENCHMARK(BM_TableFilter);
+
+// A command regex over every row, on a new sample of the same table: the
+// expression ran once per distinct string before
+void BM_ProcessFilter(Bench::State& state) {
+  ProcessFilter filter;
+  filter.Set("sh|init");
+  std::vector<std::size_t> rows;
+  for (auto _ : state) {
+    filter.Apply(Table(), Table().ByPid(), rows);
+    Bench::DoNotOptimize(rows.data());
+  }
+}
+BENCHMARK(BM_ProcessFilter);
+
+// The same while the pattern is typed, every key runs it on all distinct strings
+void BM_ProcessFilterTyped(Bench::State& state) {
+  ProcessFilter filter;
+  std::vector<std::size_t> rows;
+  bool longer{false};
+  for (auto _ : state) {
+    filter.Set(longer ? "sh|ini" : "sh|init");
+    longer = !longer;
+    filter.Apply(Table(), Table().ByPid(), rows);
+    Bench::DoNotOptimize(rows.data());
+  }
+}
+BENCHMARK(BM_ProcessFilterTyped);
+
+// Total resident memory
+void BM_LegacySumRam(Bench::State& state) {
+  for (auto _ : state) {
+    long total{0};
+    for (LegacyProcess const& process : Legacy()) { total += process.ram_kb; }
+    Bench::DoNotOptimize(total);
+  }
+}
+BENCHMARK(BM_LegacySumRam);
+
+void BM_TableSumRam(Bench::State& state) {
+  for (auto _ : state) {
+    long total{0};
+    for (long ram_kb : Table().rss_kb) { total += ram_kb; }
+    Bench::DoNotOptimize(total);
+  }
+}
+BENCHMARK(BM_TableSumRam);
+
+// Copy into a Sample, done once per tick
+void BM_LegacyCopy(Bench::State& state) {
+  std::vector<LegacyProcess> processes;
+  for (auto _ : state) {
+    processes = Legacy();
+    Bench::DoNotOptimize(processes.data());
+  }
+}
+BENCHMARK(BM_LegacyCopy);
+
+void BM_TableCopy(Bench::State& state) {
+  ProcessTable processes;
+  for (auto _ : state) {
+    processes.Assign(Table());
+    Bench::DoNotOptimize(processes.pid.data());
+  }
+}
+BENCHMARK(BM_TableCopy);
@@ -0,0 +1,203 @@
+#include <curses.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#include "bench.h"
+#include "canvas.h"
+#include "collector.h"
+#include "fake_proc.h"
+#include "format.h"
+#include "ncurses_display.h"
+#include "ranking.h"
+
+using std::string;
+using std::to_string;
+
+// Terminal output of the frame by frame redraw that used to be done versus
+// the Canvas based one. Both render the same sequence of samples into an
+// xterm whose output goes to a file, the label reports bytes per frame
+namespace {
+
+const int kRows{10};
+
+struct Terminal {
+  FILE* output;
+  FILE* input;
+  SCREEN* screen;
+  WINDOW* system_window;
+  WINDOW* process_window;
+
+  Terminal() {
+    output = tmpfile();
+    input = fopen("/dev/null", "r");
+    screen = newterm("xterm-256color", output, input);
+    start_color();
+    init_pair(1, COLOR_BLUE, COLOR_BLACK);
+    init_pair(2, COLOR_GREEN, COLOR_BLACK);
+    system_window = newwin(9, COLS - 1, 0, 0);
+    process_window = newwin(3 + kRows, COLS - 1, 9, 0);
+  }
+  ~Terminal() {
+    delwin(process_window);
+    delwin(system_window);
+    endwin();
+    delscreen(screen);
+    fclose(input);
+    fclose(output);
+  }
+  long Bytes() {
+    fflush(output);
+    return ftell(output);
+  }
+};
+
+// one sample of this machine, varied a little every frame like a live system
+struct Frames {
+  Sample sample;
+  std::vector<std::size_t> top;
+
+  Frames() {
+    System system;
+    sample.os = system.OperatingSystem();
+    sample.kernel = system.Kernel();
+    sample.processes.Assign(system.Processes());
+    Ranking::Top(sample.processes, Ranking::Key::kCpu, 2 * kRows, top);
+  }
+
+  // the bars and counters move every frame, the process rows every third one
+  std::vector<std::size_t> Next(long frame) {
+    sample.cpu = (frame % 37) / 37.0f;
+    sample.memory = 0.4f + (frame % 3) / 100.0f;
+    sample.total_processes = 1000 + frame;
+    sample.uptime = 3600 + frame;
+    std::vector<std::size_t> rows;
+    for (int i = 0; i < kRows && i < int(top.size()); ++i) {
+      rows.push_back(top[(i + frame / 3) % top.size()]);
+    }
+    return rows;
+  }
+};
+
+Frames& SharedFrames() {
+  static Frames frames;
+  return frames;
+}
+
+// The display code before the Canvas
+string LegacyProgressBar(float percent) {
+  string result{"0%"};
+  int size{50};
+  float bars{percent * size};
+  for (int i{0}; i < size; ++i) { result += i <= bars ? '|' : ' '; }
+  string display{to_string(percent * 100).substr(0, 4)};
+  if (percent < 0.1 || percent == 1.0) display = " " + to_string(percent * 100).substr(0, 3);
+  return result + " " + display + "/100%";
+}
+
+void LegacyDisplaySystem(Sample const& sample, WINDOW* window) {
+  int row{0};
+  mvwprintw(window, ++row, 2, "%s", ("OS: " + sample.os).c_str());
+  mvwprintw(window, ++row, 2, "%s", ("Kernel: " + sample.kernel).c_str());
+  mvwprintw(window, ++row, 2, "CPU: ");
+  wattron(window, COLOR_PAIR(1));
+  wmove(window, row, 10);
+  wprintw(window, "%s", LegacyProgressBar(sample.cpu).c_str());
+  wattroff(window, COLOR_PAIR(1));
+  mvwprintw(window, ++row, 2, "Memory: ");
+  wattron(window, COLOR_PAIR(1));
+  wmove(window, row, 10);
+  wprintw(window, "%s", LegacyProgressBar(sample.memory).c_str());
+  wattroff(window, COLOR_PAIR(1));
+  mvwprintw(window, ++row, 2, "%s", ("Total Processes: " + to_string(sample.total_processes)).c_str());
+  mvwprintw(window, ++row, 2, "%s", ("Running Processes: " + to_string(sample.running_processes)).c_str());
+  mvwprintw(window, ++row, 2, "%s", ("Up Time: " + Format::ElapsedTime(sample.uptime)).c_str());
+  wrefresh(window);
+}
+
+void LegacyDisplayProcesses(ProcessTable const& processes,
+                            std::vector<std::size_t> const& rows, WINDOW* window) {
+  int row{0};
+  wattron(window, COLOR_PAIR(2));
+  mvwprintw(window, ++row, 2, "PID");
+  mvwprintw(window, row, 9, "USER");
+  mvwprintw(window, row, 16, "CPU[%%]");
+  mvwprintw(window, row, 26, "RAM[MB]");
+  mvwprintw(window, row, 35, "TIME+");
+  mvwprintw(window, row, 46, "COMMAND");
+  wattroff(window, COLOR_PAIR(2));
+  for (std::size_t index : rows) {
+    mvwprintw(window, ++row, 2, "%s", string(window->_maxx - 2, ' ').c_str());
+    mvwprintw(window, row, 2, "%s", to_string(processes.pid[index]).c_str());
+    mvwprintw(window, row, 9, "%s", string(processes.User(index)).c_str());
+    mvwprintw(window, row, 16, "%s", to_string(processes.cpu[index] * 100).substr(0, 4).c_str());
+    mvwprintw(window, row, 26, "%s", Format::Megabytes(processes.rss_kb[index]).c_str());
+    mvwprintw(window, row, 35, "%s", Format::ElapsedTime(processes.uptime[index]).c_str());
+    mvwprintw(window, row, 46, "%s", string(processes.Command(index).substr(0, window->_maxx - 46)).c_str());
+  }
+}
+
+void BM_RenderLegacy(Bench::State& state) {
+  Frames& frames = SharedFrames();
+  Terminal terminal;
+  long frame{0};
+  long start = terminal.Bytes();
+  for (auto _ : state) {
+    std::vector<std::size_t> rows = frames.Next(frame++);
+    init_pair(1, COLOR_BLUE, COLOR_BLACK);
+    init_pair(2, COLOR_GREEN, COLOR_BLACK);
+    box(terminal.system_window, 0, 0);
+    box(terminal.process_window, 0, 0);
+    LegacyDisplaySystem(frames.sample, terminal.system_window);
+    LegacyDisplayProcesses(frames.sample.processes, rows, terminal.process_window);
+    wrefresh(terminal.system_window);
+    wrefresh(terminal.process_window);
+    refresh();
+  }
+  state.SetLabel(to_string((terminal.Bytes() - start) / frame) + " bytes/frame");
+}
+BENCHMARK(BM_RenderLegacy);
+
+void BM_RenderCanvas(Bench::State& state) {
+  Frames& frames = SharedFrames();
+  Terminal terminal;
+  Canvas system_canvas(terminal.system_window);
+  Canvas process_canvas(terminal.process_window);
+  long frame{0};
+  long start = terminal.Bytes();
+  for (auto _ : state) {
+    std::vector<std::size_t> rows = frames.Next(frame++);
+    NCursesDisplay::DisplaySystem(frames.sample, system_canvas);
+    NCursesDisplay::DisplayProcesses(frames.sample.processes, rows, process_canvas, kRows);
+    system_canvas.Flush();
+    process_canvas.Flush();
+    doupdate();
+  }
+  state.SetLabel(to_string((terminal.Bytes() - start) / frame) + " bytes/frame");
+}
+BENCHMARK(BM_RenderCanvas);
+
+// a whole frame of a generated tree: top rows selected, then drawn
+void BM_RenderFakeTree(Bench::State& state) {
+  Sample sample;
+  {
+    FakeProc::Root root(FakeProc::Tree(state.range()));
+    System system;
+    sample.Capture(system);
+  }
+  Terminal terminal;
+  Canvas system_canvas(terminal.system_window);
+  Canvas process_canvas(terminal.process_window);
+  std::vector<std::size_t> rows;
+  for (auto _ : state) {
+    Ranking::Top(sample.processes, Ranking::Key::kCpu, kRows, rows);
+    NCursesDisplay::DisplaySystem(sample, system_canvas);
+    NCursesDisplay::DisplayProcesses(sample.processes, rows, process_canvas, kRows);
+    system_canvas.Flush();
+    process_canvas.Flush();
+    doupdate();
+  }
+}
+BENCHMARK_ARGS(BM_RenderFakeTree, 1000, 10000, 100000);
+
+}  // namespace
@@ -0,0 +1,24 @@
+#include "bench.h"
+#include "system.h"
+
+// Scaling of the /proc scan with the number of scan workers
+// on one core the curve is flat or rising, only a multi-core run shows the pool's effect
+
+// full scan: every process is new and read from scratch
+void BM_SystemScan(Bench::State& state) {
+  for (auto _ : state) {
+    System system(int(state.range()));
+    Bench::DoNotOptimize(system.Processes().Size());
+  }
+}
+BENCHMARK_ARGS(BM_SystemScan, 1, 2, 4, 8, 16);
+
+// steady state: only the changing counters of known processes are read
+void BM_SystemRefresh(Bench::State& state) {
+  System system(int(state.range()));
+  for (auto _ : state) {
+    system.Refresh();
+    Bench::DoNotOptimize(system.Processes().Size());
+  }
+}
+BENCHMARK_ARGS(BM_SystemRefresh, 1, 2, 4, 8, 16);
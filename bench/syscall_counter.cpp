@@ -0,0 +1,48 @@
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#include "syscall_counter.h"
+
+// id of the tracepoint, -1 if tracefs is not mounted
+static long TracepointId() {
+  for (const char* path : {"/sys/kernel/tracing/events/raw_syscalls/sys_enter/id",
+                           "/sys/kernel/debug/tracing/events/raw_syscalls/sys_enter/id"}) {
+    std::ifstream file(path);
+    long id{-1};
+    if (file >> id) { return id; }
+  }
+  return -1;
+}
+
+SyscallCounter::SyscallCounter() {
+  long id = TracepointId();
+  if (id < 0) { return; }
+  perf_event_attr attr;
+  std::memset(&attr, 0, sizeof(attr));
+  attr.type = PERF_TYPE_TRACEPOINT;
+  attr.size = sizeof(attr);
+  attr.config = id;
+  attr.exclude_hv = 1;
+  fd_ = syscall(SYS_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC);
+}
+
+SyscallCounter::~SyscallCounter() {
+  if (fd_ >= 0) { close(fd_); }
+}
+
+long long SyscallCounter::Count() const {
+  long long count{0};
+  if (fd_ < 0 || read(fd_, &count, sizeof(count)) != sizeof(count)) { return -1; }
+  return count;
+}
+
+std::string SyscallCounter::Label(long long iterations) const {
+  if (!Valid()) { return "syscalls n/a (mount tracefs, run as root)"; }
+  char label[64];
+  std::snprintf(label, sizeof(label), "%.1f syscalls/op", double(Count()) / (iterations > 0 ? iterations : 1));
+  return label;
+}
@@ -0,0 +1,30 @@
+#ifndef SYSCALL_COUNTER_H
+#define SYSCALL_COUNTER_H
+
+#include <string>
+
+/*
+Syscalls made by the calling thread, counted by the kernel
+A perf counter on the raw_syscalls:sys_enter tracepoint gives the total
+strace -c reports, without stopping at every call. It needs tracefs,
+mounted at /sys/kernel/tracing or below debugfs, and perf access to
+tracepoints, usually root. Without them Valid() is false
+*/
+class SyscallCounter {
+ public:
+  SyscallCounter();
+  ~SyscallCounter();
+  SyscallCounter(SyscallCounter const&) = delete;
+  SyscallCounter& operator=(SyscallCounter const&) = delete;
+
+  bool Valid() const { return fd_ >= 0; }
+  //syscalls since construction
+  long long Count() const;
+  //"N syscalls/op" over the given number of iterations, for a benchmark label
+  std::string Label(long long iterations) const;
+
+ private:
+  int fd_{-1};
+};
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef BUDGET_H
+#define BUDGET_H
+
+/*
+CPU budget of the monitor
+After every refresh the CPU time of the whole process since the previous
+refresh is divided by the wall time in between. Over budget, idle processes
+are re-read less often first and, once that is at its limit, the sampling
+interval is stretched. With enough headroom both step back one at a time
+*/
+class Budget {
+ public:
+  //fraction of one core, e.g. 0.01; 0 only measures
+  explicit Budget(double fraction = 0.0) : fraction_(fraction) {}
+
+  //account the time since the previous call and adapt the schedule
+  void Update();
+
+  bool Enabled() const { return fraction_ > 0.0; }
+  //smoothed CPU use of the monitor, fraction of one core
+  double Used() const { return used_; }
+  //ticks between two reads of an idle process
+  int ColdPeriod() const { return cold_period_; }
+  //multiplier of the sampling interval
+  int Backoff() const { return backoff_; }
+
+ private:
+  double fraction_;
+  double used_{0.0};
+  double cpu_time_{-1.0};   // process CPU seconds at the previous update
+  double wall_time_{-1.0};  // monotonic seconds at the previous update
+  int cold_period_{1};
+  int backoff_{1};
+};
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef CANVAS_H
+#define CANVAS_H
+
+#include <curses.h>
+#include <string_view>
+#include <vector>
+
+/*
+Cell grid mirroring one ncurses window
+Each frame is drawn into the grid, Flush() compares it with the frame
+shown before and only hands the changed spans of cells to ncurses
+*/
+class Canvas {
+ public:
+  explicit Canvas(WINDOW* window);
+
+  int Rows() const { return rows_; }
+  int Cols() const { return cols_; }
+
+  //blank every cell and draw the window border
+  void Clear();
+  //write text at row/col clipped to the border, returns the column behind it
+  int Put(int row, int col, std::string_view text, chtype attributes = A_NORMAL);
+
+  //copy the changed cells into the window and queue it for doupdate()
+  void Flush();
+
+ private:
+  chtype* Row(std::vector<chtype>& cells, int row) { return cells.data() + row * cols_; }
+
+  WINDOW* window_;
+  int rows_;
+  int cols_;
+  std::vector<chtype> current_;
+  std::vector<chtype> shown_;
+};
+
+#endif
@@ -0,0 +1,71 @@
+#ifndef CGROUP_TREE_H
+#define CGROUP_TREE_H
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "delta_counter.h"
+#include "proc_parser.h"
+
+// One cgroup of the tree view
+struct CgroupUsage {
+  std::string path;
+  int depth{0};
+  int processes{0};  // in the cgroup and below
+  float cpu{0.0f};   // fraction of one core, the cgroup and below
+  long memory_kb{0};
+};
+
+/*
+The cgroup v2 hierarchy of the monitored processes
+Processes are counted in when they are added to the process table and out
+when they leave it, so a cgroup and its parents exist while a process below
+them is alive. The kernel already accounts cpu.stat and memory.current for
+a whole subtree, so a refresh reads two files per cgroup and never looks at
+the processes
+*/
+class CgroupTree {
+ public:
+  //directory the cgroup2 hierarchy is mounted at
+  explicit CgroupTree(std::string directory);
+
+  //count a process in or out of the cgroup at path, as in /proc/<pid>/cgroup
+  //empty paths (no cgroup v2) are ignored
+  void Add(std::string_view path);
+  void Remove(std::string_view path);
+
+  //re-read the usage of every cgroup, time in seconds
+  void Refresh(double time);
+
+  //depth first, the children of a cgroup by CPU, largest first
+  void Tree(std::vector<CgroupUsage>& rows) const;
+  std::size_t Size() const { return index_.size(); }
+
+ private:
+  struct Node {
+    std::string path;
+    std::string cpu_stat;        // file paths, built once
+    std::string memory_current;
+    int parent{-1};
+    int processes{0};
+    float cpu{0.0f};
+    long memory_kb{0};
+    DeltaCounter usage;  // usage_usec
+    std::vector<int> children;
+  };
+
+  //index of the node at path, created with its parents if needed
+  int Insert(std::string_view path);
+  void Erase(int node);
+  void Visit(int node, int depth, std::vector<CgroupUsage>& rows) const;
+
+  std::string directory_;
+  std::vector<Node> nodes_;  // 0 is the root, erased nodes are reused
+  std::vector<int> free_;
+  std::unordered_map<std::string, int> index_;
+  ProcParser::Buffer buffer_;
+};
+
+#endif
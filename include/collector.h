@@ -0,0 +1,89 @@
+#ifndef COLLECTOR_H
+#define COLLECTOR_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "cgroup_tree.h"
+#include "instrument.h"
+#include "process_table.h"
+#include "system.h"
+#include "task_scanner.h"
+#include "triple_buffer.h"
+
+/*
+Immutable result of one refresh, everything the display needs
+*/
+struct Sample {
+  //copy the current state of the system, reusing the buffers
+  void Capture(System& system);
+
+  unsigned long sequence{0};
+  long long time{0};  // milliseconds since the epoch
+  std::string os;
+  std::string kernel;
+  float cpu{0.0f};
+  std::vector<float> cores{};
+  std::vector<int> core_nodes{};  // NUMA node of every core
+  std::vector<float> nodes{};     // utilization of every NUMA node
+  float memory{0.0f};
+  float swap{0.0f};
+  MemInfo meminfo{};  // kB, zero on replay
+  IoRates io{};       // disk and network bytes per second, zero on replay
+  int total_processes{0};
+  int running_processes{0};
+  long uptime{0};
+  ProcessTable processes{};
+  std::vector<CgroupUsage> cgroups{};  // depth first, empty on replay
+  std::vector<ThreadUsage> threads{};  // busiest threads of the followed processes
+  std::vector<Instrument::Summary> timings{};  // the monitor's own stages, empty on replay
+  float self_cpu{0.0f};  // CPU use of the monitor, fraction of one core
+  int cold_period{1};    // ticks between two reads of an idle process
+  int backoff{1};        // the next sample is due after backoff intervals
+};
+
+//fill the next sample, e.g. refresh the system and capture it
+using Producer = std::function<void(Sample& sample)>;
+
+//producer refreshing the system, the first call captures the state it
+//was constructed with
+Producer LiveProducer(System& system);
+
+/*
+Background thread producing a Sample at a fixed interval
+Every sample is published through a triple buffer,
+so readers get the newest one without locking
+*/
+class Collector {
+ public:
+  Collector(Producer producer, std::chrono::milliseconds interval);
+  ~Collector();
+  Collector(Collector const&) = delete;
+  Collector& operator=(Collector const&) = delete;
+
+  //newest published sample, valid until the next call, single reader only
+  Sample const& Latest() { return samples_.Front(); }
+
+ private:
+  void Run();
+  void Publish();
+
+  Producer producer_;
+  std::chrono::milliseconds interval_;
+  TripleBuffer<Sample> samples_{};
+  unsigned long sequence_{0};
+  int backoff_{1};
+
+  std::mutex mutex_{};
+  std::condition_variable wake_{};
+  bool stop_{false};
+  std::thread thread_{};
+};
+
+#endif
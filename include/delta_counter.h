@@ -0,0 +1,25 @@
+#ifndef DELTA_COUNTER_H
+#define DELTA_COUNTER_H
+
+/*
+Previous sample of a monotonic counter (jiffies, bytes, ...)
+Kept per pid so rates are computed over the interval between two refreshes
+*/
+class DeltaCounter {
+ public:
+  //rate per second since the previous sample
+  //returns false on the first sample or if the counter went backwards
+  bool Update(unsigned long long value, double time, double& rate) {
+    bool valid = time_ >= 0.0 && time > time_ && value >= value_;
+    if (valid) { rate = (value - value_) / (time - time_); }
+    value_ = value;
+    time_ = time;
+    return valid;
+  }
+
+ private:
+  unsigned long long value_{0};
+  double time_{-1.0};
+};
+
+#endif
@@ -0,0 +1,76 @@
+#ifndef FD_CACHE_H
+#define FD_CACHE_H
+
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "proc_parser.h"
+#include "uring_reader.h"
+
+/*
+Open descriptors of one /proc/<pid>/<file> per process table row
+A row keeps its file open across ticks and re-reads it with pread at offset
+0, which saves an open and a close per read. The descriptor stays bound to
+the process it was opened for: once that exits, reads fail with ESRCH even
+if its pid was reused, and the descriptor is closed. An open proc file also
+holds a page of kernel memory, so at most capacity descriptors are kept. A
+row finding the cache full reads the file the usual way, and Trim() then
+evicts the least recently used descriptors for it, but never one read in
+the same tick, so a scan over more rows than fit does not thrash
+*/
+class FdCache {
+ public:
+  //file as in LinuxParser, e.g. "/stat", a seq_file; capacity 0 disables the cache
+  FdCache(std::string file, std::size_t capacity);
+  ~FdCache();
+  FdCache(FdCache const&) = delete;
+  FdCache& operator=(FdCache const&) = delete;
+
+  //raise the soft descriptor limit towards count if needed and possible,
+  //returns how many descriptors the monitor may keep open
+  static std::size_t Reserve(std::size_t count);
+
+  //append a row without a descriptor
+  void Add();
+  //close the descriptors of the rows whose flag is 0, the others keep their order
+  void Keep(std::vector<char> const& keep);
+  //contents of the file of the process at row, empty if it can not be read
+  //valid until the next read on the same thread; different rows may be read in parallel
+  std::string_view Read(std::size_t row, int pid);
+  //read the files of many rows through the ring: the rows without a descriptor
+  //open theirs in one batch, then all are read in another and the new
+  //descriptors that do not fit are closed in a third; views[i] belongs to
+  //rows[i], empty if it can not be read, valid until the next batch
+  //pids is the pid column of the table; if the ring fails, rows are read one by one
+  void ReadBatch(UringReader& ring, std::vector<std::size_t> const& rows, std::vector<int> const& pids,
+                 std::vector<std::string_view>& views);
+  //end of a tick: make room for the rows that found the cache full
+  void Trim();
+
+  std::size_t Open() const { return open_.load(std::memory_order_relaxed); }
+
+ private:
+  void Close(std::size_t row);
+
+  std::string file_;
+  std::size_t capacity_;
+  std::vector<int> fd_;              // -1 if the row has none
+  std::vector<unsigned long> used_;  // tick of the last read
+  unsigned long tick_{1};
+  std::atomic<std::size_t> open_{0};
+  std::atomic<std::size_t> missed_{0};  // reads this tick that found the cache full
+  // batch reads
+  std::vector<char> arena_;  // one slot per row of the batch
+  std::deque<std::string> overflow_;  // files longer than a slot, stable addresses
+  std::vector<ProcParser::Path> paths_;
+  std::vector<std::size_t> opening_;
+  std::vector<int> batch_fds_;
+  std::vector<int> results_;
+  std::vector<int> closing_;
+};
+
+#endif
@@ -1,10 +1,18 @@
 #ifndef FORMAT_H
 #define FORMAT_H
 
+#include <cstddef>
 #include <string>
 
 namespace Format {
 std::string ElapsedTime(long times);  // TODO: See src/format.cpp
+std::string Megabytes(long kilobytes);
+// MB with two decimals into a caller provided buffer, returns the length
+std::size_t Megabytes(long kilobytes, char* buffer, std::size_t size);
+// HH:MM:SS into a caller provided buffer, returns the length
+std::size_t ElapsedTime(long times, char* buffer, std::size_t size);
+// bytes per second as 512, 12.5K, 3.1M or 1.2G into a caller provided buffer, returns the length
+std::size_t Rate(float bytes, char* buffer, std::size_t size);
 };                                    // namespace Format
 
 #endif
\ No newline at end of file
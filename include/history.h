@@ -0,0 +1,66 @@
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "collector.h"
+#include "user_cache.h"
+
+/*
+Fixed size ring of past samples in a memory mapped file
+Every tick stores the system metrics and the top processes by CPU in
+columns (one array per metric), so disk and memory use stay bounded.
+The file survives restarts and can be replayed by another instance
+while the recording one keeps appending
+*/
+class History {
+ public:
+  static const std::uint32_t kProcesses{32};  // processes stored per tick
+  static const std::uint32_t kCommand{48};    // bytes of the command line kept
+
+  //open or create a file for recording capacity ticks, nullptr on failure
+  //a file with a different layout is recreated
+  static std::unique_ptr<History> Create(std::string const& path, std::uint32_t capacity);
+  //open an existing file read only, nullptr on failure
+  static std::unique_ptr<History> Open(std::string const& path);
+
+  ~History();
+  History(History const&) = delete;
+  History& operator=(History const&) = delete;
+
+  //store the sample as the newest tick, overwriting the oldest when full
+  void Append(Sample const& sample);
+
+  //ticks are numbered since the file was created, [First(), End()) is stored
+  std::uint64_t First() const;
+  std::uint64_t End() const;
+  //first stored tick at or after time (ms since the epoch), End() if none
+  std::uint64_t Find(long long time) const;
+  //fill the sample with a stored tick, false if it is gone or being overwritten
+  bool Read(std::uint64_t tick, UserCache const& users, Sample& sample) const;
+
+ private:
+  struct Header;
+  struct Columns;
+
+  History(int fd, void* data, std::size_t size);
+  //walk the file layout, sets the columns if base is given, returns the file size
+  static std::size_t Layout(std::uint32_t capacity, char* base, Columns& columns);
+  static std::size_t FileSize(std::uint32_t capacity);
+  static bool Matches(void const* data, std::size_t size, std::uint32_t capacity);
+
+  int fd_;
+  void* data_;
+  std::size_t size_;
+  Header* header_{nullptr};
+  std::unique_ptr<Columns> columns_;
+};
+
+//producer replaying a history file from the given tick, one tick per sample
+//the last tick is repeated once the end is reached
+Producer ReplayProducer(History const& history, std::uint64_t tick);
+
+#endif
@@ -0,0 +1,61 @@
+#ifndef INSTRUMENT_H
+#define INSTRUMENT_H
+
+#include <chrono>
+#include <vector>
+
+/*
+Timers for the monitor's own work
+Every stage keeps a call count, the total and last duration and a log-linear
+histogram (four buckets per power of two), all in relaxed atomics so spans on
+the collector and display threads record without locking.
+A Span costs two steady_clock reads, which are vDSO calls on Linux
+*/
+namespace Instrument {
+enum class Stage {
+  kPids,      // enumerating the pids
+  kSystem,    // /proc/stat, /proc/meminfo, /proc/uptime and the CPU deltas
+  kUpdate,    // re-reading known processes
+  kNew,       // reading processes seen for the first time
+  kCgroups,   // the usage of the cgroups
+  kSmaps,     // PSS and USS of the largest processes
+  kThreads,   // threads of the busiest processes
+  kRank,      // selecting the top rows
+  kOutput,    // drawing a frame or writing a sample
+  kCount
+};
+
+const char* Name(Stage stage);
+
+//add one measurement of a stage
+void Record(Stage stage, std::chrono::nanoseconds duration);
+
+//times the scope it lives in
+class Span {
+ public:
+  explicit Span(Stage stage) : stage_(stage), start_(std::chrono::steady_clock::now()) {}
+  ~Span() { Record(stage_, std::chrono::steady_clock::now() - start_); }
+  Span(Span const&) = delete;
+  Span& operator=(Span const&) = delete;
+
+ private:
+  Stage stage_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+// Totals of one stage since the start, durations in microseconds
+// the percentiles are bucket midpoints, within an eighth of the real value
+struct Summary {
+  const char* name{""};
+  unsigned long long count{0};
+  double last{0.0};
+  double mean{0.0};
+  double p50{0.0};
+  double p99{0.0};
+};
+
+//one summary per stage, in the order of Stage
+void Summarize(std::vector<Summary>& summaries);
+};  // namespace Instrument
+
+#endif
@@ -1,15 +1,15 @@
 #ifndef SYSTEM_PARSER_H
 #define SYSTEM_PARSER_H
 
-#include <fstream>
-#include <regex>
 #include <string>
+#include <vector>
+
+#include "proc_parser.h"
 
 namespace LinuxParser {
 // Paths
 const std::string kProcDirectory{"/proc/"};
 const std::string kCmdlineFilename{"/cmdline"};
-const std::string kCpuinfoFilename{"/cpuinfo"};
 const std::string kStatusFilename{"/status"};
 const std::string kStatFilename{"/stat"};
 const std::string kUptimeFilename{"/uptime"};
@@ -17,40 +17,70 @@ const std::string kMeminfoFilename{"/meminfo"};
 const std::string kVersionFilename{"/version"};
 const std::string kOSPath{"/etc/os-release"};
 const std::string kPasswordPath{"/etc/passwd"};
+const std::string kCgroupFilename{"/cgroup"};
+const std::string kSmapsRollupFilename{"/smaps_rollup"};
+const std::string kIoFilename{"/io"};
+const std::string kDiskstatsFilename{"/diskstats"};
+const std::string kNetDevFilename{"/net/dev"};
+const std::string kTaskDirectory{"/task"};
+const std::string kCommFilename{"/comm"};
+const std::string kMountinfoFilename{"/self/mountinfo"};
+const std::string kCgroupDirectory{"/sys/fs/cgroup"};
+const std::string kNodeDirectory{"/sys/devices/system/node/"};
+const std::string kCpulistFilename{"/cpulist"};
 
 // Filters
 const std::string filterProcesses{"processes"};
 const std::string filterRunningProcesses{"procs_running"};
 const std::string filterMemTotalString{"MemTotal:"};
 const std::string filterMemFreeString{"MemFree:"};
+const std::string filterMemAvailableString{"MemAvailable:"};
 const std::string filterBufferString{"Buffers:"};
 const std::string filterCachedString{"Cached:"};
+const std::string filterShmemString{"Shmem:"};
+const std::string filterSlabReclaimableString{"SReclaimable:"};
+const std::string filterSlabUnreclaimableString{"SUnreclaim:"};
+const std::string filterSwapTotalString{"SwapTotal:"};
+const std::string filterSwapFreeString{"SwapFree:"};
 const std::string filterCpu{"cpu"};
 const std::string filterUID{"Uid:"};
-const std::string filterProcMem{"VmRSS:"};
+const std::string filterPss{"Pss:"};
+const std::string filterPrivateClean{"Private_Clean:"};
+const std::string filterPrivateDirty{"Private_Dirty:"};
+
+// Proc root, kProcDirectory unless it was moved, e.g. to a generated tree
+// set it before any System is created
+std::string const& ProcDirectory();
+void SetProcDirectory(std::string directory);
 
 // System
-float MemoryUtilization();
-long UpTime();
 std::vector<int> Pids();
-int TotalProcesses();
-int RunningProcesses();
 std::string OperatingSystem();
 std::string Kernel();
+// mount point of the cgroup v2 hierarchy, kCgroupDirectory if none is found
+std::string CgroupDirectory();
 
-// CPU
-std::vector<std::string> CpuUtilization();
-
-// helper
-bool is_number(const std::string& s);
+// NUMA node of every cpu id, -1 for ids in no node, empty without NUMA support
+std::vector<int> CpuNodes();
 
 // Processes
 std::string Command(int pid);
-std::string Ram(int pid);
-std::string Uid(int pid);
-std::string User(int pid);
-std::vector<std::string> CpuUtilization(int pid);
-long int UpTime(int pid);
+// proportional and unique set size from smaps_rollup, false if it can not be read
+// (gone, or another user's process without ptrace access)
+bool SmapsRollup(int pid, long& pss_kb, long& uss_kb);
+int Uid(int pid);
+// I/O counters, false if they can not be read (gone, or no ptrace access)
+bool Io(int pid, ProcParser::PidIo& io);
+bool Stat(int pid, ProcParser::PidStat& stat);
+// Threads
+// thread ids of a process, empty if it is gone
+std::vector<int> Tasks(int pid);
+bool TaskStat(int pid, int tid, ProcParser::PidStat& stat);
+// thread name, e.g. "GC Thread#0"
+std::string TaskName(int pid, int tid);
+
+// cgroup v2 path of a process, e.g. "/system.slice/cron.service", empty if none
+std::string Cgroup(int pid);
 };  // namespace LinuxParser
 
 #endif
\ No newline at end of file
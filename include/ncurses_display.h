@@ -2,15 +2,37 @@
 #define NCURSES_DISPLAY_H
 
 #include <curses.h>
+#include <chrono>
+#include <functional>
+#include <limits>
+#include <string_view>
 
-#include "process.h"
-#include "system.h"
+#include "canvas.h"
+#include "cgroup_tree.h"
+#include "collector.h"
+#include "instrument.h"
+#include "process_filter.h"
+#include "process_table.h"
+#include "ranking.h"
+#include "task_scanner.h"
 
 namespace NCursesDisplay {
-void Display(System& system, int n = 10);
-void DisplaySystem(System& system, WINDOW* window);
-void DisplayProcesses(std::vector<Process>& processes, WINDOW* window, int n);
-std::string ProgressBar(float percent);
+void Display(Collector& collector, int n = 10,
+             std::chrono::milliseconds redraw = std::chrono::milliseconds(100),
+             Ranking::Key key = Ranking::Key::kCpu,
+             std::function<void(bool, int)> threads = {});
+void DisplaySystem(Sample const& sample, Canvas& canvas);
+//columns the core map needs at least: a node label and 8 cores
+constexpr int kCoresWidth{16};
+void DisplayCores(Sample const& sample, Canvas& canvas, int first_row, int col);
+void DisplayProcesses(ProcessTable const& processes,
+                      std::vector<std::size_t> const& rows, Canvas& canvas, int n,
+                      std::size_t selected = std::numeric_limits<std::size_t>::max());
+void DisplayCgroups(std::vector<CgroupUsage> const& cgroups, Canvas& canvas, int n);
+void DisplayThreads(std::vector<ThreadUsage> const& threads, Canvas& canvas, int n);
+void DisplayTimings(Sample const& sample, std::vector<Instrument::Summary> const& timings,
+                    Canvas& canvas);
+std::string_view ProgressBar(float percent, char (&buffer)[64]);
 };  // namespace NCursesDisplay
 
 #endif
\ No newline at end of file
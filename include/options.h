@@ -0,0 +1,41 @@
+#ifndef OPTIONS_H
+#define OPTIONS_H
+
+#include <string>
+
+#include "ranking.h"
+#include "stream_writer.h"
+
+/*
+Command line options of the monitor executable
+*/
+struct Options {
+  int threads{1};      // workers scanning /proc
+  int interval{1000};  // milliseconds between two samples
+  int redraw{100};     // milliseconds between checks for a new sample or key
+  Ranking::Key sort{Ranking::Key::kCpu};
+  bool events{false};  // follow pids through the proc connector
+  double budget{0.0};  // CPU budget of the monitor, fraction of one core, 0 for none
+  int pss{0};          // processes with the most RSS whose PSS/USS is read, 0 for none
+  int tasks{0};        // processes with the most CPU whose threads are followed, 0 for none
+  int fds{1024};       // stat and io descriptors each kept open across samples
+  bool uring{false};   // read the stat and io files in batches through io_uring
+  std::string proc{};  // proc root, empty for /proc
+
+  // headless mode, samples are streamed instead of drawn
+  bool headless{false};
+  StreamWriter::Format format{StreamWriter::Format::kJson};
+  std::string file{};  // empty for stdout
+  long count{0};       // samples to write, 0 is unlimited
+
+  // history ring file to record into, or to replay from
+  std::string history{};
+  long history_size{3600};  // ticks kept in the ring
+  std::string replay{};
+  long replay_at{-1};       // seconds after local midnight to start the replay at
+
+  //parse argv, prints the usage and exits on invalid arguments
+  static Options Parse(int argc, char* argv[]);
+};
+
+#endif
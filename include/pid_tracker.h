@@ -0,0 +1,46 @@
+#ifndef PID_TRACKER_H
+#define PID_TRACKER_H
+
+#include <unordered_set>
+#include <vector>
+
+/*
+Set of live pids, optionally kept up to date by the kernel proc connector
+With events enabled, fork, exec and exit notifications arrive over a netlink
+socket and a tick no longer lists /proc. It falls back to listing /proc every
+tick when the connector is unavailable (it needs CAP_NET_ADMIN), and lists it
+once more whenever events were lost. A process that exited since the last
+update is still reported by the next one, so one that started and exited
+between two samples shows up once. It can only be read while its parent has
+not reaped it: a zombie's stat holds its final CPU time, and the connector
+itself carries no accounting
+*/
+class PidTracker {
+ public:
+  //subscribe to the proc connector if events is true
+  explicit PidTracker(bool events = false);
+  ~PidTracker();
+  PidTracker(PidTracker const&) = delete;
+  PidTracker& operator=(PidTracker const&) = delete;
+
+  //the current pids, the ones that exec'd a new program and the ones a new
+  //process was forked with since the last update (both only known with events)
+  void Update(std::vector<int>& pids, std::vector<int>& exec, std::vector<int>& forked);
+  //true while the pids come from connector events
+  bool Events() const { return socket_ >= 0; }
+
+ private:
+  //open the netlink socket and wait for the kernel to acknowledge
+  bool Subscribe();
+  //apply the queued events, false if the socket overflowed and events were lost
+  bool Drain(std::vector<int>& exec, std::vector<int>& forked);
+
+  int socket_{-1};
+  bool scan_{true};  // the next update lists /proc
+  unsigned long updates_{0};
+  std::unordered_set<int> pids_;
+  std::unordered_set<int> exited_;  // exit events not yet confirmed gone, still in pids_
+  std::vector<char> buffer_;
+};
+
+#endif
@@ -0,0 +1,137 @@
+#ifndef PROC_PARSER_H
+#define PROC_PARSER_H
+
+#include <charconv>
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+/*
+Allocation free parsing of /proc files
+Files are read with open/pread into a reusable buffer and scanned in place,
+LinuxParser is a thin layer on top of it
+*/
+namespace ProcParser {
+
+// Reusable read buffer, only grows when a file does not fit
+class Buffer {
+ public:
+  Buffer(std::size_t capacity = 4096) : data_(capacity) {}
+
+  std::string_view View() const { return {data_.data(), size_}; }
+  char* Data() { return data_.data(); }
+  std::size_t Capacity() const { return data_.size(); }
+  void Resize(std::size_t size) { size_ = size; }
+  void Grow() { data_.resize(data_.size() * 2); }
+
+ private:
+  std::vector<char> data_;
+  std::size_t size_{0};
+};
+
+// Fixed size path for /proc/<pid>/<file> without touching the heap
+class Path {
+ public:
+  Path(std::string_view directory, std::string_view file);
+  Path(std::string_view directory, int pid, std::string_view file);
+  //directory/<pid>/task/<tid>/file
+  Path(std::string_view directory, int pid, int tid, std::string_view file);
+
+  const char* c_str() const { return data_; }
+  bool Valid() const { return valid_; }
+
+ private:
+  void Append(std::string_view part);
+
+  char data_[256];
+  std::size_t size_{0};
+  bool valid_{true};
+};
+
+// Read the whole file into the buffer, false if it can not be read
+bool ReadFile(const char* path, Buffer& buffer);
+// Read the file into the buffer from an already open descriptor
+bool ReadFile(int fd, Buffer& buffer);
+
+// Sequential tokenizer over whitespace separated text
+class Scanner {
+ public:
+  explicit Scanner(std::string_view text)
+      : pos_(text.data()), end_(text.data() + text.size()) {}
+
+  bool Done() const { return pos_ >= end_; }
+  std::string_view Rest() const { return {pos_, std::size_t(end_ - pos_)}; }
+
+  // skip blanks (not newlines)
+  void SkipBlanks();
+  // move behind the next newline
+  void SkipLine();
+  // skip n whitespace separated fields on the current line
+  void SkipFields(int n);
+  // return the next whitespace separated field
+  std::string_view Field();
+
+  // parse the next field as a number, false if it is not one
+  template <typename T>
+  bool Number(T& value) {
+    SkipBlanks();
+    auto result = std::from_chars(pos_, end_, value);
+    if (result.ec != std::errc()) { return false; }
+    pos_ = result.ptr;
+    return true;
+  }
+
+ private:
+  const char* pos_;
+  const char* end_;
+};
+
+// Find a "Key: value" line (meminfo, status, stat style) and parse its value
+template <typename T>
+bool FindValue(std::string_view text, std::string_view key, T& value) {
+  std::size_t pos = 0;
+  while (pos < text.size()) {
+    if (text.compare(pos, key.size(), key) == 0) {
+      Scanner scanner(text.substr(pos + key.size()));
+      return scanner.Number(value);
+    }
+    pos = text.find('\n', pos);
+    if (pos == std::string_view::npos) { break; }
+    ++pos;
+  }
+  return false;
+}
+
+// Fields of /proc/<pid>/stat, see proc(5)
+struct PidStat {
+  char state{'?'};
+  int ppid{0};
+  unsigned long long utime{0};
+  unsigned long long stime{0};
+  long long cutime{0};
+  long long cstime{0};
+  long num_threads{0};
+  unsigned long long start_time{0};
+  unsigned long long vsize{0};
+  long long rss{0};
+};
+
+// Parse a /proc/<pid>/stat line, the command may contain spaces and parens
+bool ParsePidStat(std::string_view text, PidStat& stat);
+
+// Counters of /proc/<pid>/io, see proc(5)
+struct PidIo {
+  unsigned long long rchar{0};        // bytes passed to read(), any file or socket
+  unsigned long long wchar{0};
+  unsigned long long syscr{0};        // read syscalls
+  unsigned long long syscw{0};
+  unsigned long long read_bytes{0};   // bytes fetched from storage
+  unsigned long long write_bytes{0};  // bytes sent to storage
+};
+
+// Parse /proc/<pid>/io, false unless all fields were found
+bool ParsePidIo(std::string_view text, PidIo& io);
+
+};  // namespace ProcParser
+
+#endif
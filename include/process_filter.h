@@ -0,0 +1,42 @@
+#ifndef PROCESS_FILTER_H
+#define PROCESS_FILTER_H
+
+#include <cstddef>
+#include <regex>
+#include <string>
+#include <vector>
+
+#include "process_table.h"
+
+/*
+Rows whose user name or command matches a regular expression
+Users and commands are interned, so the expression is run once per distinct
+string and the result cached by its id; a row then costs two lookups. The
+cache follows the table's generation and lives as long as the pattern, so
+filtering every new sample only runs the expression on strings new to it
+*/
+class ProcessFilter {
+ public:
+  //ECMAScript syntax, case insensitive; empty matches every row
+  //false if the pattern is invalid, the previous one stays in effect then
+  bool Set(std::string const& pattern);
+  std::string const& Pattern() const { return pattern_; }
+  bool Empty() const { return pattern_.empty(); }
+  //times the expression was run since Set, the cache misses
+  std::size_t Searches() const { return searches_; }
+
+  //the rows of order that match, in its order
+  void Apply(ProcessTable const& processes, std::vector<std::size_t> const& order,
+             std::vector<std::size_t>& rows);
+
+ private:
+  bool Matches(ProcessTable const& processes, StringArena::Id id);
+
+  std::string pattern_;
+  std::regex regex_;
+  unsigned long generation_{0};
+  std::vector<signed char> matches_;  // per string id: 1 match, 0 none, -1 not yet run
+  std::size_t searches_{0};
+};
+
+#endif
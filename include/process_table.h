@@ -0,0 +1,139 @@
+#ifndef PROCESS_TABLE_H
+#define PROCESS_TABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "delta_counter.h"
+#include "proc_parser.h"
+
+/*
+Strings referenced by a 32 bit id
+All of them live in one buffer, so copying the arena is two memcpys
+*/
+class StringArena {
+ public:
+  using Id = std::uint32_t;
+
+  //store a copy of text, returns its id
+  Id Add(std::string_view text);
+  std::string_view Get(Id id) const {
+    return std::string_view(data_.data() + spans_[id].offset, spans_[id].length);
+  }
+  std::size_t Size() const { return spans_.size(); }
+  std::size_t Bytes() const { return data_.size(); }
+  void Clear();
+
+ private:
+  struct Span {
+    std::uint32_t offset;
+    std::uint32_t length;
+  };
+
+  std::string data_;
+  std::vector<Span> spans_;
+};
+
+// Previous /proc/<pid>/io counters of a row
+struct IoCounters {
+  DeltaCounter read;      // read_bytes
+  DeltaCounter write;     // write_bytes
+  DeltaCounter syscalls;  // syscr + syscw
+};
+
+/*
+Columnar table of processes
+Every attribute is a contiguous array indexed by row, so ranking, filtering
+and aggregating only scan the columns they need. User names and commands are
+interned into a string arena and rows refer to them by id, as are the cgroups.
+Nothing is formatted here, that is left to the rows that get displayed.
+Two orders of the rows, by pid and by user, are kept as indexes: Keep()
+filters them along with the columns and Index() merges the rows added
+since, so a view sorted by either is a slice instead of a sort
+*/
+class ProcessTable {
+ public:
+  std::size_t Size() const { return pid.size(); }
+
+  //append a row with zeroed counters and no PSS/USS, returns its index
+  std::size_t Add(int pid, int uid, std::string_view user, std::string_view command,
+                  std::string_view cgroup = {});
+  //drop the rows whose flag is 0, the others keep their order
+  void Keep(std::vector<char> const& keep);
+  //store the counters of one refresh in a row
+  //the CPU is utime + stime over the interval since the previous refresh, like top
+  //a newly seen row has no previous sample and uses its lifetime average
+  void Store(std::size_t row, ProcParser::PidStat const& stat, long rss_kb, double uptime);
+  //store the I/O counters of a row, rates like the CPU, a new row uses its lifetime average
+  void StoreIo(std::size_t row, ProcParser::PidIo const& io, double uptime);
+  //replace the command of a row, e.g. after the process exec'd
+  void SetCommand(std::size_t row, std::string_view command) { command_[row] = Intern(command); }
+  void Clear();
+  //copy the rows of another table, reusing the capacities
+  //the intern index is left out, the copy is meant for reading and gets its orders merged
+  void Assign(ProcessTable const& other);
+  //merge the rows added since the last call into the orders
+  void Index();
+
+  //rows by ascending pid, and by user name then pid, as of the last Index()
+  std::vector<std::size_t> const& ByPid() const { return by_pid_; }
+  std::vector<std::size_t> const& ByUser() const { return by_user_; }
+  //row of pid, Size() if it is not in the table
+  std::size_t Find(int pid) const;
+
+  std::string_view User(std::size_t row) const { return strings_.Get(user_[row]); }
+  std::string_view Command(std::size_t row) const { return strings_.Get(command_[row]); }
+  std::string_view Cgroup(std::size_t row) const { return strings_.Get(cgroup_[row]); }
+  //interned ids of the strings of a row, equal strings share one
+  StringArena::Id UserId(std::size_t row) const { return user_[row]; }
+  StringArena::Id CommandId(std::size_t row) const { return command_[row]; }
+  std::string_view String(StringArena::Id id) const { return strings_.Get(id); }
+  //changes whenever the ids are handed out anew (Clear, compaction), so a
+  //cache keyed by id is valid as long as this stays the same; copies share it
+  unsigned long Generation() const { return generation_; }
+
+  //clock ticks per second of the counters
+  static float Hertz();
+  //kB per page, the unit of the rss in stat
+  static long PageKb();
+
+  // columns, one entry per row
+  std::vector<int> pid;
+  std::vector<int> uid;
+  std::vector<unsigned long long> start_time;  // clock ticks after boot
+  std::vector<unsigned long long> utime;       // clock ticks
+  std::vector<unsigned long long> stime;       // clock ticks
+  std::vector<long> rss_kb;
+  std::vector<long> uptime;            // seconds
+  std::vector<float> cpu;              // fraction of one core
+  std::vector<DeltaCounter> cpu_time;  // utime + stime of the previous refresh
+  std::vector<long> pss_kb;            // from smaps_rollup, -1 if never read
+  std::vector<long> uss_kb;            // private pages, -1 if never read
+  std::vector<unsigned long> smaps_tick;  // tick of the last smaps_rollup read, 0 for none
+  std::vector<float> read_rate;      // bytes/s fetched from storage, -1 if io can not be read
+  std::vector<float> write_rate;     // bytes/s sent to storage, -1 if unknown
+  std::vector<float> syscall_rate;   // read and write syscalls/s, -1 if unknown
+  std::vector<IoCounters> io_counters;
+
+ private:
+  StringArena::Id Intern(std::string_view text);
+  //rebuild the arena from the live rows once it is mostly garbage
+  void Compact();
+  //a generation no table had before
+  static unsigned long NextGeneration();
+
+  std::vector<StringArena::Id> user_;
+  std::vector<StringArena::Id> command_;
+  std::vector<StringArena::Id> cgroup_;
+  StringArena strings_;
+  std::unordered_map<std::string, StringArena::Id> index_;
+  unsigned long generation_{NextGeneration()};
+  std::vector<std::size_t> by_pid_;
+  std::vector<std::size_t> by_user_;
+};
+
+#endif
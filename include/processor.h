@@ -1,9 +1,45 @@
 #ifndef PROCESSOR_H
 #define PROCESSOR_H
 
+#include <cstdint>
+#include <vector>
+
+#include "system_snapshot.h"
+
+/*
+CPU utilization between two refreshes
+The jiffies of the previous snapshot are kept, so no extra sampling is needed.
+Per core the columns of the snapshot are walked in one branch free pass
+that keeps only the low halves of the previous sums, cores are grouped by
+their NUMA node
+*/
 class Processor {
  public:
-  float Utilization(); 
+  //reads the NUMA topology once
+  Processor();
+
+  //compute utilization against the previous snapshot
+  void Update(SystemSnapshot const& snapshot);
+
+  float Utilization() const;                          // aggregate of all cores
+  std::vector<float> const& CoreUtilization() const;  // one entry per cpuN line
+  std::vector<int> const& CoreNodes() const;          // NUMA node of every entry
+  std::vector<float> const& NodeUtilization() const;  // one entry per node
+
+ private:
+  static float Utilization(CpuTimes const& previous, CpuTimes const& current);
+
+  CpuTimes previous_{};
+  float utilization_{0.0f};
+  std::vector<int> cpu_nodes_;  // node of every cpu id
+  std::vector<int> ids_;        // cpu ids the per core columns belong to
+  std::vector<std::uint32_t> previous_idle_;   // low halves of the
+  std::vector<std::uint32_t> previous_total_;  // per core sums
+  std::vector<std::int32_t> busy_delta_;
+  std::vector<std::int32_t> total_delta_;
+  std::vector<float> core_utilization_{};
+  std::vector<int> core_nodes_{};
+  std::vector<float> node_utilization_{};
 };
 
-#endif
\ No newline at end of file
+#endif
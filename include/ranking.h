@@ -0,0 +1,55 @@
+#ifndef RANKING_H
+#define RANKING_H
+
+#include <cstddef>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "process_table.h"
+
+/*
+Top-N selection over the process table
+Only the rows that are shown get ordered: the key column is copied into a
+compact array of (key, index) pairs, the n largest are selected with
+nth_element and only those are sorted. Pid and user run ascending and are
+read off the table's indexes instead
+*/
+namespace Ranking {
+enum class Key { kCpu, kRam, kPid, kUpTime, kUser, kRead, kWrite, kSyscalls, kCount };
+
+//parse "cpu", "ram", "pid", "time", "user", "read", "write" or "syscalls",
+//false if the name is unknown
+bool ParseKey(std::string const& name, Key& key);
+//the name ParseKey takes
+char const* Name(Key key);
+
+//indices of the first n processes by key, the largest first, or the lowest
+//pid and user name
+void Top(ProcessTable const& processes, Key key, std::size_t n,
+         std::vector<std::size_t>& top);
+
+//rows as the key orders them, candidates for Page() and Position(): the
+//table's index for pid and user, in pid order for the other keys
+std::vector<std::size_t> const& Order(ProcessTable const& processes, Key key);
+//the n rows from position first on in the order by key of rows, a subset
+//of Order() in its order, e.g. the ones passing a filter
+void Page(ProcessTable const& processes, Key key, std::vector<std::size_t> const& rows,
+          std::size_t first, std::size_t n, std::vector<std::size_t>& page);
+//position of row in that order, rows.size() if it is not among rows
+std::size_t Position(ProcessTable const& processes, Key key, std::vector<std::size_t> const& rows,
+                     std::size_t row);
+
+// Page of a list that follows one pid
+struct Cursor {
+  std::size_t first{0};  // position the page starts at
+  std::size_t selected{std::numeric_limits<std::size_t>::max()};  // row of the pid, max if not found
+  bool found{false};
+};
+//the page of n rows of rows holding pid, in the order by key as for Page();
+//the first page if pid is 0 or not among rows
+Cursor Follow(ProcessTable const& processes, Key key, std::vector<std::size_t> const& rows, int pid,
+              std::size_t n);
+};  // namespace Ranking
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef SCAN_POOL_H
+#define SCAN_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+Fixed pool of worker threads for the /proc scan
+Run() splits the index range into one shard per worker, every worker drains
+its own shard in small chunks and then steals chunks from the other shards
+The calling thread takes part as worker 0, so a pool of size 1 has no threads
+*/
+class ScanPool {
+ public:
+  //task(begin, end, worker) handles the indices [begin, end)
+  using Task = std::function<void(std::size_t, std::size_t, int)>;
+
+  explicit ScanPool(int threads = 1);
+  ~ScanPool();
+  ScanPool(ScanPool const&) = delete;
+  ScanPool& operator=(ScanPool const&) = delete;
+
+  int Size() const { return size_; }
+
+  //run the task over [0, count), returns when all indices are done
+  void Run(std::size_t count, Task const& task);
+
+ private:
+  // cursor of one shard on its own cache line, advanced by its owner and thieves
+  struct alignas(64) Shard {
+    std::atomic<std::size_t> next{0};
+    std::size_t end{0};
+  };
+
+  void Work(int worker);
+  void Drain(int worker);
+
+  static const std::size_t kChunk{32};
+
+  int size_;
+  std::unique_ptr<Shard[]> shards_;
+  std::vector<std::thread> threads_{};
+
+  std::mutex mutex_{};
+  std::condition_variable start_{};
+  std::condition_variable done_{};
+  Task const* task_{nullptr};
+  unsigned long generation_{0};
+  int running_{0};
+  bool stop_{false};
+};
+
+#endif
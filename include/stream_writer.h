@@ -0,0 +1,45 @@
+#ifndef STREAM_WRITER_H
+#define STREAM_WRITER_H
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "collector.h"
+
+/*
+Headless output of samples for scripts and collectors
+  json:   one JSON object per sample and line
+  csv:    a "system" row and one "process" row per process for each sample
+  binary: length prefixed little endian records, see WriteBinary()
+*/
+class StreamWriter {
+ public:
+  enum class Format { kJson, kCsv, kBinary };
+
+  //parse "json", "csv" or "binary", false if the name is unknown
+  static bool ParseFormat(std::string const& name, Format& format);
+
+  StreamWriter(std::FILE* out, Format format) : out_(out), format_(format) {}
+
+  void Write(Sample const& sample);
+
+  //produce a sample every interval and write count samples, 0 is unlimited
+  void Stream(Producer const& producer, std::chrono::milliseconds interval, long count);
+
+ private:
+  void WriteJson(Sample const& sample);
+  void WriteCsv(Sample const& sample);
+  void WriteBinary(Sample const& sample);
+  void JsonString(std::string_view text);
+  void CsvString(std::string_view text);
+
+  std::FILE* out_;
+  Format format_;
+  bool header_{false};
+  std::vector<char> record_{};
+};
+
+#endif
@@ -1,34 +1,107 @@
 #ifndef SYSTEM_H
 #define SYSTEM_H
 
+#include <atomic>
+#include <cstddef>
+#include <memory>
 #include <string>
 #include <vector>
 
-#include "process.h"
+#include "budget.h"
+#include "cgroup_tree.h"
+#include "fd_cache.h"
+#include "pid_tracker.h"
+#include "process_table.h"
 #include "processor.h"
+#include "scan_pool.h"
 #include "linux_parser.h"
+#include "system_snapshot.h"
+#include "task_scanner.h"
+#include "uring_reader.h"
+#include "user_cache.h"
+
+// System wide I/O over the last refresh interval, bytes per second
+struct IoRates {
+  float disk_read{0.0f};
+  float disk_write{0.0f};
+  float net_receive{0.0f};
+  float net_send{0.0f};
+};
 
 class System {
  public:
   //constructor to extract all relevant info upon initialization
-  System() { processes_ = Processes(); }
+  //threads: number of workers scanning /proc
+  //events: follow new and exited pids through the proc connector instead of listing /proc
+  //budget: CPU budget of the monitor as a fraction of one core, 0 for none
+  //smaps: number of processes with the most RSS whose PSS and USS are read, 0 for none
+  //fds: stat and io descriptors each kept open across ticks, 0 opens the files for every read
+  //uring: read the stat and io files of known processes in batches through io_uring if the kernel allows
+  explicit System(int threads = 1, bool events = false, double budget = 0.0, int smaps = 0,
+                  int fds = 1024, bool uring = false);
+
+  //read the system wide files once and update all processes
+  void Refresh();
 
   Processor& Cpu();                   // TODO: See src/system.cpp
-  std::vector<Process>& Processes();  // TODO: See src/system.cpp
+  ProcessTable const& Processes();    // TODO: See src/system.cpp
   float MemoryUtilization();          // TODO: See src/system.cpp
+  float SwapUtilization();
+  MemInfo const& Memory();
+  IoRates const& Io();
   long UpTime();                      // TODO: See src/system.cpp
   int TotalProcesses();               // TODO: See src/system.cpp
   int RunningProcesses();             // TODO: See src/system.cpp
   std::string Kernel();               // TODO: See src/system.cpp
   std::string OperatingSystem();      // TODO: See src/system.cpp
+  Budget const& CpuBudget();
+  CgroupTree const& Cgroups();
+  //follow the threads of the given number of processes with the most CPU
+  //0 stops, may be called from any thread, takes effect at the next refresh
+  void ScanThreads(int processes);
+  //follow the threads of this pid as well while threads are scanned, 0 for none
+  //may be called from any thread, takes effect at the next refresh
+  void FollowThreads(int pid);
+  int FollowedThreads() const { return followed_.load(std::memory_order_relaxed); }
+  TaskScanner const& Threads();
 
   // Define any necessary private members
  private:
+  //refresh the persistent process table from the current snapshot
+  void UpdateProcesses();
+  //re-read the given rows through the ring, keep[row] is 0 for the exited ones
+  void RefreshRows(std::vector<std::size_t> const& rows, double uptime, std::vector<char>& keep);
+  //re-read smaps_rollup of the largest processes once their values are stale
+  void UpdateSmaps();
+  //rates of the disk and network totals of the snapshot
+  void UpdateIo();
+
+  SystemSnapshot snapshot_ = {};
   Processor cpu_ = {};
+  IoRates io_;
+  DeltaCounter disk_read_;
+  DeltaCounter disk_write_;
+  DeltaCounter net_receive_;
+  DeltaCounter net_send_;
+  UserCache users_ = {};
+  ScanPool pool_;
+  PidTracker pids_;
+  Budget budget_;
+  CgroupTree cgroups_;
+  int smaps_;
+  std::atomic<int> thread_processes_{0};
+  std::atomic<int> followed_{0};
+  TaskScanner tasks_;
+  unsigned long tick_{0};
   std::string kernel_;
   std::string os_;
   
-  std::vector<Process> processes_ = {};
+  ProcessTable processes_ = {};
+  std::size_t fd_limit_;  // descriptors each cache may keep, half of what RLIMIT_NOFILE allowed
+  // one row per row of processes_
+  FdCache stat_fds_;
+  FdCache io_fds_;
+  std::unique_ptr<UringReader> uring_;  // null unless enabled
 };
 
 #endif
\ No newline at end of file
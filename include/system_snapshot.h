@@ -0,0 +1,115 @@
+#ifndef SYSTEM_SNAPSHOT_H
+#define SYSTEM_SNAPSHOT_H
+
+#include <cstdint>
+#include <vector>
+
+#include "proc_parser.h"
+
+// Jiffies of one "cpu" line of /proc/stat
+struct CpuTimes {
+  unsigned long long user{0};
+  unsigned long long nice{0};
+  unsigned long long system{0};
+  unsigned long long idle{0};
+  unsigned long long iowait{0};
+  unsigned long long irq{0};
+  unsigned long long softirq{0};
+  unsigned long long steal{0};
+
+  // idle = idle + iowait
+  unsigned long long Idle() const { return idle + iowait; }
+  // nonidle = user + nice + system + irq + softirq + steal
+  unsigned long long NonIdle() const { return user + nice + system + irq + softirq + steal; }
+  unsigned long long Total() const { return Idle() + NonIdle(); }
+};
+
+/*
+Jiffies of all "cpuN" lines of /proc/stat in one contiguous block
+The block is stored by field: Column(f) holds the f-th counter (CpuTimes
+order) of every core back to back, so per core arithmetic runs over
+contiguous arrays and vectorizes. Offline cores have no line, Ids()[i] is
+the N of the i-th line
+*/
+class CpuMatrix {
+ public:
+  static constexpr std::size_t kFields{8};  // user nice system idle iowait irq softirq steal
+  static constexpr std::size_t kIdle{3};
+  static constexpr std::size_t kIowait{4};
+
+  std::size_t Cores() const { return ids_.size(); }
+  std::vector<int> const& Ids() const { return ids_; }
+  std::uint64_t const* Column(std::size_t field) const { return values_.data() + field * capacity_; }
+
+ private:
+  friend class SystemSnapshot;
+
+  //set the counters of the core at index, growing the columns if needed
+  std::uint64_t* Reserve(std::size_t core);
+
+  std::vector<std::uint64_t> values_;  // kFields columns of capacity_ entries
+  std::size_t capacity_{0};
+  std::vector<int> ids_;
+};
+
+// Values of /proc/meminfo in kB
+struct MemInfo {
+  unsigned long long total{0};
+  unsigned long long free{0};
+  unsigned long long available{0};
+  unsigned long long buffers{0};
+  unsigned long long cached{0};
+  unsigned long long shmem{0};
+  unsigned long long slab_reclaimable{0};
+  unsigned long long slab_unreclaimable{0};
+  unsigned long long swap_total{0};
+  unsigned long long swap_free{0};
+};
+
+// Cumulative bytes of /proc/diskstats and /proc/net/dev
+struct IoTotals {
+  unsigned long long disk_read{0};  // whole disks only, partitions and stacked devices would count twice
+  unsigned long long disk_written{0};
+  unsigned long long net_received{0};  // all interfaces but lo
+  unsigned long long net_sent{0};
+};
+
+/*
+System wide values of one refresh
+/proc/stat, /proc/meminfo, /proc/uptime, /proc/diskstats and /proc/net/dev are each read and parsed once,
+so System, Processor and the process table all work with numbers from the same instant
+*/
+class SystemSnapshot {
+ public:
+  // Re-read all system wide files
+  void Refresh();
+
+  float MemoryUtilization() const;
+  float SwapUtilization() const;
+  double UpTime() const { return uptime_; }
+  int TotalProcesses() const { return total_processes_; }
+  int RunningProcesses() const { return running_processes_; }
+  MemInfo const& Memory() const { return memory_; }
+  IoTotals const& Io() const { return io_; }
+  // aggregate of all cores
+  CpuTimes const& Cpu() const { return cpu_; }
+  // one row per cpuN line
+  CpuMatrix const& Cores() const { return cores_; }
+
+ private:
+  void ParseStat(std::string_view text);
+  void ParseMeminfo(std::string_view text);
+  void ParseDiskstats(std::string_view text);
+  void ParseNetDev(std::string_view text);
+
+  ProcParser::Buffer buffer_;
+  double uptime_{0.0};
+  int total_processes_{0};
+  int running_processes_{0};
+  MemInfo memory_;
+  IoTotals io_;
+  CpuTimes cpu_;
+  CpuMatrix cores_;
+};
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef TASK_SCANNER_H
+#define TASK_SCANNER_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "process_table.h"
+#include "scan_pool.h"
+
+// One thread of the thread view
+struct ThreadUsage {
+  int pid{0};  // process the thread belongs to
+  int tid{0};
+  float cpu{0.0f};  // fraction of one core
+  std::string name;
+};
+
+/*
+Threads of a few selected processes
+The threads live in a ProcessTable of their own, the tid in the pid column
+and the thread name as the command, so they get the same per id delta
+counters and the same ranking as the processes. Every update lists the task
+directories, but reads at most a batch of stat files: new threads first,
+then the known ones round robin. A process with thousands of threads is
+covered over a few ticks, meanwhile the other rows keep their last rate
+*/
+class TaskScanner {
+ public:
+  //batch: stat files read per update
+  explicit TaskScanner(std::size_t batch = 2048) : batch_(batch) {}
+
+  //follow the threads of pids, rows of other processes are dropped
+  //uptime in seconds, the stat files are read on the pool
+  void Update(std::vector<int> const& pids, double uptime, ScanPool& pool);
+
+  //the n threads with the most CPU, largest first; those of first_pid come
+  //before all others, so a selected process shows all of its threads
+  void Top(std::size_t n, std::vector<ThreadUsage>& rows, int first_pid = 0) const;
+  std::size_t Size() const { return threads_.Size(); }
+
+ private:
+  //drop the rows whose flag is 0
+  void Keep(std::vector<char> const& keep);
+
+  ProcessTable threads_;
+  std::vector<int> owner_;  // pid of every row
+  std::size_t cursor_{0};   // next known row to re-read
+  std::size_t batch_;
+};
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+
+#include <atomic>
+
+/*
+Lock free handoff of the newest value from one writer to one reader
+The writer fills Back() and publishes it, the reader takes the newest
+published value with Front(). Neither side ever waits for the other and
+the three slots are reused, so their buffers keep their capacity
+*/
+template <typename T>
+class TripleBuffer {
+ public:
+  //slot owned by the writer
+  T& Back() { return slots_[back_]; }
+
+  //swap the written slot into the middle, marked as fresh
+  void Publish() {
+    back_ = middle_.exchange(back_ | kFresh, std::memory_order_acq_rel) & kIndex;
+  }
+
+  //newest published slot, stays valid until the next call
+  T const& Front() {
+    if (middle_.load(std::memory_order_relaxed) & kFresh) {
+      front_ = middle_.exchange(front_, std::memory_order_acq_rel) & kIndex;
+    }
+    return slots_[front_];
+  }
+
+ private:
+  static const unsigned kIndex{3};
+  static const unsigned kFresh{4};
+
+  T slots_[3]{};
+  unsigned back_{0};
+  std::atomic<unsigned> middle_{1};
+  unsigned front_{2};
+};
+
+#endif
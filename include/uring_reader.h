@@ -0,0 +1,70 @@
+#ifndef URING_READER_H
+#define URING_READER_H
+
+#include <cstddef>
+#include <vector>
+
+#include "proc_parser.h"
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+/*
+Batched open, read and close through io_uring
+Every call fills the submission ring with one request per entry and waits
+for all of them with a single io_uring_enter per ring full, instead of one
+syscall per file. The ring is set up with the raw syscalls, without
+liburing. Kernels without io_uring, or with it disabled (sysctl
+kernel.io_uring_disabled, seccomp), leave Available() false and callers
+keep the synchronous path. /proc files cannot be read without blocking, so
+the kernel hands those reads to its io-wq workers, which read many files
+at once on a machine with spare cores
+*/
+class UringReader {
+ public:
+  //entries: requests submitted per io_uring_enter
+  explicit UringReader(unsigned entries = 1024);
+  ~UringReader();
+  UringReader(UringReader const&) = delete;
+  UringReader& operator=(UringReader const&) = delete;
+
+  bool Available() const { return ring_ >= 0; }
+
+  //results[i]: descriptor of paths[i] opened read only, or -errno
+  void Open(std::vector<ProcParser::Path> const& paths, std::vector<int>& results);
+  //read up to slot bytes at offset 0 of fds[i] into arena + i * slot,
+  //results[i]: bytes read or -errno; negative fds are skipped with -EBADF
+  void Read(std::vector<int> const& fds, char* arena, std::size_t slot, std::vector<int>& results);
+  //close the non-negative fds
+  void Close(std::vector<int> const& fds);
+
+  //io_uring_enter calls so far
+  unsigned long Enters() const { return enters_; }
+
+ private:
+  //prepare(sqe, i) fills the request of entry i, results[i] gets its completion
+  template <typename Prepare>
+  void Submit(std::size_t count, Prepare prepare, std::vector<int>& results);
+  //unmap and close the ring, Available() is false afterwards
+  void Shutdown();
+
+  int ring_{-1};
+  unsigned entries_{0};
+  // mappings of the submission queue, completion queue and submission entries
+  void* sq_ring_{nullptr};
+  void* cq_ring_{nullptr};
+  std::size_t sq_ring_size_{0};  // both rings share one mapping
+  io_uring_sqe* sqes_{nullptr};
+  std::size_t sqes_size_{0};
+  // pointers into the rings
+  unsigned* sq_tail_{nullptr};
+  unsigned* sq_mask_{nullptr};
+  unsigned* sq_array_{nullptr};
+  unsigned* cq_head_{nullptr};
+  unsigned* cq_tail_{nullptr};
+  unsigned* cq_mask_{nullptr};
+  io_uring_cqe* cqes_{nullptr};
+  unsigned long enters_{0};
+};
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef USER_CACHE_H
+#define USER_CACHE_H
+
+#include <ctime>
+#include <string>
+#include <vector>
+
+/*
+UID to user name map loaded from /etc/passwd
+The file is only parsed again when its modification time changes,
+lookups go through a flat open addressing table
+*/
+class UserCache {
+ public:
+  //reload /etc/passwd if it changed since the last load
+  void Refresh();
+
+  //user name of the uid, the uid itself if it has no passwd entry
+  std::string Name(int uid) const;
+
+ private:
+  struct Entry {
+    int uid{-1};
+    int name{-1};  // index into names_
+  };
+
+  void Load();
+  void Insert(int uid, std::string name);
+  std::size_t Slot(int uid) const;
+
+  std::vector<Entry> table_{};
+  std::vector<std::string> names_{};
+  std::timespec mtime_{};
+  bool loaded_{false};
+};
+
+#endif
@@ -0,0 +1,45 @@
+#include <time.h>
+#include <algorithm>
+
+#include "budget.h"
+
+// Idle processes are read at least every kMaxCold ticks, the interval
+// is stretched at most kMaxBackoff times
+static const int kMaxCold{16};
+static const int kMaxBackoff{8};
+// weight of the newest measurement in the smoothed use
+static const double kSmoothing{0.5};
+
+static double Seconds(clockid_t clock) {
+  timespec now;
+  clock_gettime(clock, &now);
+  return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+// Step up while over budget, step down below half of it, the gap in
+// between keeps the schedule from flapping
+void Budget::Update() {
+  double cpu_time = Seconds(CLOCK_PROCESS_CPUTIME_ID);
+  double wall_time = Seconds(CLOCK_MONOTONIC);
+  if (wall_time_ >= 0.0 && wall_time > wall_time_) {
+    double used = (cpu_time - cpu_time_) / (wall_time - wall_time_);
+    used_ = used_ > 0.0 ? kSmoothing * used + (1.0 - kSmoothing) * used_ : used;
+  }
+  cpu_time_ = cpu_time;
+  wall_time_ = wall_time;
+  if (!Enabled()) { return; }
+
+  if (used_ > fraction_) {
+    if (cold_period_ < kMaxCold) {
+      cold_period_ *= 2;
+    } else {
+      backoff_ = std::min(backoff_ * 2, kMaxBackoff);
+    }
+  } else if (used_ < fraction_ / 2) {
+    if (backoff_ > 1) {
+      backoff_ /= 2;
+    } else {
+      cold_period_ = std::max(cold_period_ / 2, 1);
+    }
+  }
+}
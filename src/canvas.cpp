@@ -0,0 +1,60 @@
+#include <algorithm>
+
+#include "canvas.h"
+
+// shown_ starts with a value no cell can have, so the first flush writes everything
+Canvas::Canvas(WINDOW* window)
+    : window_(window),
+      rows_(getmaxy(window)),
+      cols_(getmaxx(window)),
+      current_(rows_ * cols_, ' '),
+      shown_(rows_ * cols_, ~chtype(0)) {}
+
+void Canvas::Clear() {
+  std::fill(current_.begin(), current_.end(), chtype(' '));
+  if (rows_ < 2 || cols_ < 2) { return; }
+  for (int col = 1; col < cols_ - 1; ++col) {
+    Row(current_, 0)[col] = ACS_HLINE;
+    Row(current_, rows_ - 1)[col] = ACS_HLINE;
+  }
+  for (int row = 1; row < rows_ - 1; ++row) {
+    Row(current_, row)[0] = ACS_VLINE;
+    Row(current_, row)[cols_ - 1] = ACS_VLINE;
+  }
+  Row(current_, 0)[0] = ACS_ULCORNER;
+  Row(current_, 0)[cols_ - 1] = ACS_URCORNER;
+  Row(current_, rows_ - 1)[0] = ACS_LLCORNER;
+  Row(current_, rows_ - 1)[cols_ - 1] = ACS_LRCORNER;
+}
+
+int Canvas::Put(int row, int col, std::string_view text, chtype attributes) {
+  if (row < 1 || row >= rows_ - 1) { return col; }
+  chtype* cells = Row(current_, row);
+  for (char c : text) {
+    if (col >= cols_ - 1) { break; }
+    if (col >= 1) { cells[col] = chtype(static_cast<unsigned char>(c)) | attributes; }
+    ++col;
+  }
+  return col;
+}
+
+// Write each run of changed cells with one call
+void Canvas::Flush() {
+  for (int row = 0; row < rows_; ++row) {
+    chtype* current = Row(current_, row);
+    chtype* shown = Row(shown_, row);
+    int col = 0;
+    while (col < cols_) {
+      if (current[col] == shown[col]) {
+        ++col;
+        continue;
+      }
+      int start = col;
+      while (col < cols_ && current[col] != shown[col]) { ++col; }
+      // waddchnstr does not move the cursor or wrap, so the last cell is safe too
+      mvwaddchnstr(window_, row, start, current + start, col - start);
+    }
+  }
+  std::copy(current_.begin(), current_.end(), shown_.begin());
+  wnoutrefresh(window_);
+}
@@ -0,0 +1,100 @@
+#include <algorithm>
+
+#include "cgroup_tree.h"
+
+using std::string;
+using std::string_view;
+using std::vector;
+
+CgroupTree::CgroupTree(string directory) : directory_(std::move(directory)) { Insert("/"); }
+
+// "/" is the root, every other path is a child of the part before its last slash
+int CgroupTree::Insert(string_view path) {
+  auto found = index_.find(string(path));
+  if (found != index_.end()) { return found->second; }
+
+  int parent = -1;
+  if (path != "/") {
+    std::size_t slash = path.rfind('/');
+    parent = Insert(slash == 0 || slash == string_view::npos ? "/" : path.substr(0, slash));
+  }
+  int node;
+  if (free_.empty()) {
+    node = int(nodes_.size());
+    nodes_.emplace_back();
+  } else {
+    node = free_.back();
+    free_.pop_back();
+    nodes_[node] = Node();
+  }
+  Node& entry = nodes_[node];
+  entry.path = string(path);
+  string directory = directory_ + (path == "/" ? string() : entry.path);
+  entry.cpu_stat = directory + "/cpu.stat";
+  entry.memory_current = directory + "/memory.current";
+  entry.parent = parent;
+  if (parent >= 0) { nodes_[parent].children.push_back(node); }
+  index_.emplace(entry.path, node);
+  return node;
+}
+
+void CgroupTree::Erase(int node) {
+  vector<int>& siblings = nodes_[nodes_[node].parent].children;
+  siblings.erase(std::find(siblings.begin(), siblings.end(), node));
+  index_.erase(nodes_[node].path);
+  nodes_[node] = Node();
+  free_.push_back(node);
+}
+
+void CgroupTree::Add(string_view path) {
+  if (path.empty()) { return; }
+  for (int node = Insert(path); node >= 0; node = nodes_[node].parent) { ++nodes_[node].processes; }
+}
+
+// A cgroup without processes below it is dropped, the root stays
+void CgroupTree::Remove(string_view path) {
+  if (path.empty()) { return; }
+  auto found = index_.find(string(path));
+  if (found == index_.end()) { return; }
+  for (int node = found->second; node >= 0;) {
+    int parent = nodes_[node].parent;
+    if (--nodes_[node].processes == 0 && parent >= 0) { Erase(node); }
+    node = parent;
+  }
+}
+
+// usage_usec is the first line of cpu.stat, memory.current is in bytes
+// the root has no memory.current, it stays 0
+void CgroupTree::Refresh(double time) {
+  for (auto const& entry : index_) {
+    Node& node = nodes_[entry.second];
+    unsigned long long usage{0};
+    double rate{0.0};
+    node.cpu = 0.0f;
+    if (ProcParser::ReadFile(node.cpu_stat.c_str(), buffer_) &&
+        ProcParser::FindValue(buffer_.View(), "usage_usec", usage) &&
+        node.usage.Update(usage, time, rate)) {
+      node.cpu = rate / 1e6;
+    }
+    unsigned long long bytes{0};
+    if (ProcParser::ReadFile(node.memory_current.c_str(), buffer_)) {
+      ProcParser::Scanner(buffer_.View()).Number(bytes);
+    }
+    node.memory_kb = long(bytes / 1024);
+  }
+}
+
+void CgroupTree::Visit(int node, int depth, vector<CgroupUsage>& rows) const {
+  Node const& entry = nodes_[node];
+  rows.push_back({entry.path, depth, entry.processes, entry.cpu, entry.memory_kb});
+  vector<int> children(entry.children);
+  std::sort(children.begin(), children.end(), [this](int a, int b) {
+    return nodes_[a].cpu > nodes_[b].cpu || (nodes_[a].cpu == nodes_[b].cpu && nodes_[a].path < nodes_[b].path);
+  });
+  for (int child : children) { Visit(child, depth + 1, rows); }
+}
+
+void CgroupTree::Tree(vector<CgroupUsage>& rows) const {
+  rows.clear();
+  Visit(0, 0, rows);
+}
@@ -0,0 +1,77 @@
+#include <algorithm>
+
+#include "collector.h"
+
+// threads kept in a sample, more than any window shows
+static const std::size_t kThreads{64};
+
+// Publish the first sample right away, then keep producing in the background
+Collector::Collector(Producer producer, std::chrono::milliseconds interval)
+    : producer_(std::move(producer)), interval_(interval) {
+  Publish();
+  thread_ = std::thread(&Collector::Run, this);
+}
+
+Collector::~Collector() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  wake_.notify_one();
+  thread_.join();
+}
+
+// Assigning into a reused sample keeps the vector capacities
+void Sample::Capture(System& system) {
+  time = std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::system_clock::now().time_since_epoch()).count();
+  os = system.OperatingSystem();
+  kernel = system.Kernel();
+  cpu = system.Cpu().Utilization();
+  cores = system.Cpu().CoreUtilization();
+  core_nodes = system.Cpu().CoreNodes();
+  nodes = system.Cpu().NodeUtilization();
+  memory = system.MemoryUtilization();
+  swap = system.SwapUtilization();
+  meminfo = system.Memory();
+  io = system.Io();
+  total_processes = system.TotalProcesses();
+  running_processes = system.RunningProcesses();
+  uptime = system.UpTime();
+  processes.Assign(system.Processes());
+  system.Cgroups().Tree(cgroups);
+  system.Threads().Top(kThreads, threads, system.FollowedThreads());
+  Instrument::Summarize(timings);
+  self_cpu = system.CpuBudget().Used();
+  cold_period = system.CpuBudget().ColdPeriod();
+  backoff = system.CpuBudget().Backoff();
+}
+
+Producer LiveProducer(System& system) {
+  return [&system, first = true](Sample& sample) mutable {
+    if (!first) { system.Refresh(); }
+    first = false;
+    sample.Capture(system);
+  };
+}
+
+// Produce into the back slot and hand it over
+void Collector::Publish() {
+  Sample& sample = samples_.Back();
+  producer_(sample);
+  sample.sequence = ++sequence_;
+  backoff_ = sample.backoff;
+  samples_.Publish();
+}
+
+void Collector::Run() {
+  auto next = std::chrono::steady_clock::now() + interval_;
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!wake_.wait_until(lock, next, [this] { return stop_; })) {
+    lock.unlock();
+    Publish();
+    // keep the cadence, but do not try to catch up after a slow refresh
+    next = std::max(next + interval_ * backoff_, std::chrono::steady_clock::now());
+    lock.lock();
+  }
+}
@@ -0,0 +1,209 @@
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <utility>
+
+#include "fd_cache.h"
+#include "linux_parser.h"
+#include "proc_parser.h"
+
+using std::size_t;
+using std::vector;
+
+// Descriptors left for everything else the monitor opens
+static const size_t kSpare{256};
+// Bytes per file in a batch, stat and io lines are well below
+static const size_t kSlot{1024};
+// Rows per round of batched open, read and close
+static const size_t kChunk{1024};
+
+static ProcParser::Buffer& ReadBuffer() {
+  thread_local ProcParser::Buffer buffer;
+  return buffer;
+}
+
+// stat, io and status are seq_files, which fill a read as far as the file
+// goes, so a read shorter than the buffer is the whole file and the pread
+// that would return 0 is saved; a full buffer falls back to reading on
+static bool ReadSeqFile(int fd, ProcParser::Buffer& buffer) {
+  ssize_t n;
+  do {
+    n = pread(fd, buffer.Data(), buffer.Capacity(), 0);
+  } while (n < 0 && errno == EINTR);
+  if (n < 0) {
+    buffer.Resize(0);
+    return false;
+  }
+  if (std::size_t(n) < buffer.Capacity()) {
+    buffer.Resize(n);
+    return true;
+  }
+  return ProcParser::ReadFile(fd, buffer);
+}
+
+FdCache::FdCache(std::string file, size_t capacity) : file_(std::move(file)), capacity_(capacity) {}
+
+FdCache::~FdCache() {
+  for (int fd : fd_) {
+    if (fd >= 0) { close(fd); }
+  }
+}
+
+size_t FdCache::Reserve(size_t count) {
+  rlimit limit;
+  if (getrlimit(RLIMIT_NOFILE, &limit) != 0) { return 0; }
+  rlim_t wanted = count + kSpare;
+  if (limit.rlim_cur != RLIM_INFINITY && limit.rlim_cur < wanted) {
+    rlimit raised = limit;
+    raised.rlim_cur = limit.rlim_max == RLIM_INFINITY ? wanted : std::min(wanted, limit.rlim_max);
+    if (setrlimit(RLIMIT_NOFILE, &raised) == 0) { limit = raised; }
+  }
+  if (limit.rlim_cur == RLIM_INFINITY) { return count; }
+  return limit.rlim_cur > kSpare ? std::min<size_t>(count, limit.rlim_cur - kSpare) : 0;
+}
+
+void FdCache::Add() {
+  fd_.push_back(-1);
+  used_.push_back(0);
+}
+
+void FdCache::Close(size_t row) {
+  close(fd_[row]);
+  fd_[row] = -1;
+  open_.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void FdCache::Keep(vector<char> const& keep) {
+  size_t kept = 0;
+  for (size_t row = 0; row < fd_.size(); ++row) {
+    if (!keep[row]) {
+      if (fd_[row] >= 0) { Close(row); }
+      continue;
+    }
+    fd_[kept] = fd_[row];
+    used_[kept] = used_[row];
+    ++kept;
+  }
+  fd_.resize(kept);
+  used_.resize(kept);
+}
+
+// A failed pread on a cached descriptor is ESRCH: the process is gone
+std::string_view FdCache::Read(size_t row, int pid) {
+  ProcParser::Buffer& buffer = ReadBuffer();
+  used_[row] = tick_;
+  if (fd_[row] >= 0) {
+    if (ReadSeqFile(fd_[row], buffer)) { return buffer.View(); }
+    Close(row);
+    return {};
+  }
+
+  ProcParser::Path path(LinuxParser::ProcDirectory(), pid, file_);
+  int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) { return {}; }
+  if (!ReadSeqFile(fd, buffer)) {
+    close(fd);
+    return {};
+  }
+  if (open_.fetch_add(1, std::memory_order_relaxed) < capacity_) {
+    fd_[row] = fd;
+  } else {
+    open_.fetch_sub(1, std::memory_order_relaxed);
+    if (capacity_ > 0) { missed_.fetch_add(1, std::memory_order_relaxed); }
+    close(fd);
+  }
+  return buffer.View();
+}
+
+// A row's own descriptor that fails to read is ESRCH as in Read(). The rows
+// go through the ring a chunk at a time, so the descriptors opened for rows
+// that do not fit into the cache stay a chunk's worth and not the whole
+// batch's, which would run into the descriptor limit on large systems. A
+// request the ring could not take, or an open refused for lack of
+// descriptors, is read the synchronous way
+void FdCache::ReadBatch(UringReader& ring, vector<size_t> const& rows, vector<int> const& pids,
+                        vector<std::string_view>& views) {
+  size_t count = rows.size();
+  views.assign(count, {});
+  overflow_.clear();
+  arena_.resize(count * kSlot);
+  for (size_t first = 0; first < count; first += kChunk) {
+    size_t chunk = std::min(kChunk, count - first);
+    batch_fds_.assign(chunk, -1);
+    vector<char> fallback(chunk, 0);
+
+    paths_.clear();
+    opening_.clear();
+    for (size_t k = 0; k < chunk; ++k) {
+      size_t row = rows[first + k];
+      used_[row] = tick_;
+      if (fd_[row] >= 0) {
+        batch_fds_[k] = fd_[row];
+      } else {
+        opening_.push_back(k);
+        paths_.emplace_back(LinuxParser::ProcDirectory(), pids[row], file_);
+      }
+    }
+    ring.Open(paths_, results_);
+    for (size_t j = 0; j < opening_.size(); ++j) {
+      int result = results_[j];
+      if (result >= 0) { batch_fds_[opening_[j]] = result; }
+      if (result == -ECANCELED || result == -EMFILE || result == -ENFILE) { fallback[opening_[j]] = 1; }
+    }
+
+    ring.Read(batch_fds_, arena_.data() + first * kSlot, kSlot, results_);
+    closing_.clear();
+    for (size_t k = 0; k < chunk; ++k) {
+      size_t row = rows[first + k];
+      int fd = batch_fds_[k];
+      int bytes = results_[k];
+      bool cached = fd_[row] >= 0;
+      std::string_view& view = views[first + k];
+      if (fallback[k] || bytes == -ECANCELED) {
+        if (!cached && fd >= 0) { closing_.push_back(fd); }
+        overflow_.emplace_back(Read(row, pids[row]));
+        view = overflow_.back();
+        continue;
+      }
+      if (bytes >= 0 && size_t(bytes) < kSlot) {
+        view = std::string_view(arena_.data() + (first + k) * kSlot, bytes);
+      } else if (bytes >= 0 && ReadSeqFile(fd, ReadBuffer())) {
+        overflow_.emplace_back(ReadBuffer().View());
+        view = overflow_.back();
+      }
+      if (cached) {
+        if (view.empty()) {
+          closing_.push_back(fd);
+          fd_[row] = -1;
+          open_.fetch_sub(1, std::memory_order_relaxed);
+        }
+      } else if (fd >= 0) {
+        if (!view.empty() && Open() < capacity_) {
+          fd_[row] = fd;
+          open_.fetch_add(1, std::memory_order_relaxed);
+        } else {
+          if (!view.empty() && capacity_ > 0) { missed_.fetch_add(1, std::memory_order_relaxed); }
+          closing_.push_back(fd);
+        }
+      }
+    }
+    ring.Close(closing_);
+  }
+}
+
+// Rows read this tick are in use, only older ones are evicted, oldest first
+void FdCache::Trim() {
+  size_t missed = missed_.exchange(0, std::memory_order_relaxed);
+  if (missed > 0) {
+    vector<std::pair<unsigned long, size_t>> idle;
+    for (size_t row = 0; row < fd_.size(); ++row) {
+      if (fd_[row] >= 0 && used_[row] < tick_) { idle.emplace_back(used_[row], row); }
+    }
+    size_t evict = std::min(missed, idle.size());
+    if (evict < idle.size()) { std::nth_element(idle.begin(), idle.begin() + evict, idle.end()); }
+    for (size_t i = 0; i < evict; ++i) { Close(idle[i].second); }
+  }
+  ++tick_;
+}
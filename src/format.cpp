@@ -1,6 +1,8 @@
+#include <algorithm>
 #include <string>
 #include <iostream>
 #include <chrono>
+#include <cstdio>
 
 #include "format.h"
 
@@ -27,4 +29,45 @@ string Format::ElapsedTime(long s) {
     formatted += std::to_string(seconds.count());
      
     return formatted;
-}
\ No newline at end of file
+}
+
+// Helper function
+// INPUT: memory in kB
+// OUTPUT: MB with two decimals
+string Format::Megabytes(long kb) {
+    //convert from kB to MB
+    string value = std::to_string(kb * 0.001);
+    return value.substr(0, value.size() - 4);
+}
+
+// Helper function without allocation for the display
+// INPUT: Long int measuring seconds, output buffer
+// OUTPUT: HH:MM:SS in the buffer, its length
+std::size_t Format::ElapsedTime(long s, char* buffer, std::size_t size) {
+    int length = std::snprintf(buffer, size, "%02ld:%02ld:%02ld", s / 3600, (s / 60) % 60, s % 60);
+    return length < 0 ? 0 : std::min(std::size_t(length), size - 1);
+}
+
+// Helper function without allocation for the display
+// INPUT: memory in kB, output buffer
+// OUTPUT: MB with two decimals in the buffer, its length
+std::size_t Format::Megabytes(long kb, char* buffer, std::size_t size) {
+    // same digits as Megabytes(kb): six decimals, the last four cut off
+    int length = std::snprintf(buffer, size, "%f", kb * 0.001) - 4;
+    return length < 0 ? 0 : std::min(std::size_t(length), size - 1);
+}
+
+// Helper function without allocation for the display
+// INPUT: bytes per second, output buffer
+// OUTPUT: 1024 based, one decimal once scaled, in the buffer, its length
+std::size_t Format::Rate(float bytes, char* buffer, std::size_t size) {
+    const char* units = "KMGT";
+    int unit = -1;
+    while (bytes >= 1024 && unit < 3) {
+        bytes /= 1024;
+        ++unit;
+    }
+    int length = unit < 0 ? std::snprintf(buffer, size, "%.0f", bytes)
+                          : std::snprintf(buffer, size, "%.1f%c", bytes, units[unit]);
+    return length < 0 ? 0 : std::min(std::size_t(length), size - 1);
+}
@@ -0,0 +1,264 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <vector>
+
+#include "history.h"
+#include "ranking.h"
+#include "user_cache.h"
+
+using std::size_t;
+using std::uint32_t;
+using std::uint64_t;
+
+static const char kMagic[8] = {'M', 'O', 'N', 'H', 'I', 'S', 'T', '\0'};
+static const uint32_t kVersion{1};
+
+struct History::Header {
+  char magic[8];
+  uint32_t version;
+  uint32_t capacity;   // ticks in the ring
+  uint32_t processes;  // process rows per tick
+  uint32_t command;    // bytes per command
+  uint64_t end;        // ticks written so far, published after the columns
+  char os[128];
+  char kernel[64];
+};
+
+// One array per metric, system columns are indexed by slot,
+// process columns by slot * processes + row
+struct History::Columns {
+  int64_t* time;
+  int64_t* uptime;
+  float* cpu;
+  float* memory;
+  int32_t* total_processes;
+  int32_t* running_processes;
+  uint32_t* count;
+  int32_t* pid;
+  int32_t* uid;
+  float* process_cpu;
+  int64_t* ram_kb;
+  int64_t* process_uptime;
+  char* command;
+};
+
+template <typename T>
+static void Column(size_t& offset, size_t count, char* base, T*& column) {
+  offset = (offset + 63) & ~size_t(63);
+  column = base ? reinterpret_cast<T*>(base + offset) : nullptr;
+  offset += count * sizeof(T);
+}
+
+size_t History::FileSize(uint32_t capacity) {
+  Columns columns;
+  return Layout(capacity, nullptr, columns);
+}
+
+size_t History::Layout(uint32_t capacity, char* base, Columns& c) {
+  size_t rows = size_t(capacity) * kProcesses;
+  size_t offset = sizeof(Header);
+  Column(offset, capacity, base, c.time);
+  Column(offset, capacity, base, c.uptime);
+  Column(offset, capacity, base, c.cpu);
+  Column(offset, capacity, base, c.memory);
+  Column(offset, capacity, base, c.total_processes);
+  Column(offset, capacity, base, c.running_processes);
+  Column(offset, capacity, base, c.count);
+  Column(offset, rows, base, c.pid);
+  Column(offset, rows, base, c.uid);
+  Column(offset, rows, base, c.process_cpu);
+  Column(offset, rows, base, c.ram_kb);
+  Column(offset, rows, base, c.process_uptime);
+  Column(offset, rows * kCommand, base, c.command);
+  return offset;
+}
+
+History::History(int fd, void* data, size_t size)
+    : fd_(fd), data_(data), size_(size), header_(static_cast<Header*>(data)), columns_(new Columns) {
+  Layout(header_->capacity, static_cast<char*>(data_), *columns_);
+}
+
+History::~History() {
+  munmap(data_, size_);
+  close(fd_);
+}
+
+bool History::Matches(void const* data, size_t size, uint32_t capacity) {
+  if (size < sizeof(Header)) { return false; }
+  Header const* header = static_cast<Header const*>(data);
+  return std::memcmp(header->magic, kMagic, sizeof(kMagic)) == 0 && header->version == kVersion &&
+         header->processes == kProcesses && header->command == kCommand &&
+         (capacity == 0 || header->capacity == capacity);
+}
+
+std::unique_ptr<History> History::Create(std::string const& path, uint32_t capacity) {
+  int fd = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+  if (fd < 0) { return nullptr; }
+  size_t size = FileSize(capacity);
+
+  // keep the recorded ticks if the layout is the same, start over otherwise
+  struct stat info;
+  bool keep = fstat(fd, &info) == 0 && size_t(info.st_size) == size;
+  if (!keep && (ftruncate(fd, 0) != 0 || ftruncate(fd, size) != 0)) {
+    close(fd);
+    return nullptr;
+  }
+  void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (data == MAP_FAILED) {
+    close(fd);
+    return nullptr;
+  }
+  if (!keep || !Matches(data, size, capacity)) {
+    std::memset(data, 0, sizeof(Header));
+    Header* header = static_cast<Header*>(data);
+    std::memcpy(header->magic, kMagic, sizeof(kMagic));
+    header->version = kVersion;
+    header->capacity = capacity;
+    header->processes = kProcesses;
+    header->command = kCommand;
+  }
+  return std::unique_ptr<History>(new History(fd, data, size));
+}
+
+std::unique_ptr<History> History::Open(std::string const& path) {
+  int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) { return nullptr; }
+  struct stat info;
+  void* data = MAP_FAILED;
+  if (fstat(fd, &info) == 0 && size_t(info.st_size) >= sizeof(Header)) {
+    data = mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  }
+  if (data == MAP_FAILED || !Matches(data, info.st_size, 0) ||
+      FileSize(static_cast<Header*>(data)->capacity) != size_t(info.st_size)) {
+    if (data != MAP_FAILED) { munmap(data, info.st_size); }
+    close(fd);
+    errno = EINVAL;
+    return nullptr;
+  }
+  return std::unique_ptr<History>(new History(fd, data, info.st_size));
+}
+
+uint64_t History::End() const { return __atomic_load_n(&header_->end, __ATOMIC_ACQUIRE); }
+
+uint64_t History::First() const {
+  uint64_t end = End();
+  return end > header_->capacity ? end - header_->capacity : 0;
+}
+
+// Binary search, the times of the stored ticks are ascending
+uint64_t History::Find(long long time) const {
+  uint64_t low = First(), high = End();
+  while (low < high) {
+    uint64_t middle = low + (high - low) / 2;
+    if (columns_->time[middle % header_->capacity] < time) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
+  }
+  return low;
+}
+
+static void CopyString(char* target, size_t size, std::string_view text) {
+  size_t length = std::min(size - 1, text.size());
+  std::memcpy(target, text.data(), length);
+  std::memset(target + length, 0, size - length);
+}
+
+// Write the slot of the next tick, then publish it by advancing end
+void History::Append(Sample const& sample) {
+  Columns& c = *columns_;
+  uint64_t tick = header_->end;
+  size_t slot = tick % header_->capacity;
+
+  CopyString(header_->os, sizeof(header_->os), sample.os);
+  CopyString(header_->kernel, sizeof(header_->kernel), sample.kernel);
+  c.time[slot] = sample.time;
+  c.uptime[slot] = sample.uptime;
+  c.cpu[slot] = sample.cpu;
+  c.memory[slot] = sample.memory;
+  c.total_processes[slot] = sample.total_processes;
+  c.running_processes[slot] = sample.running_processes;
+
+  thread_local std::vector<size_t> top;
+  Ranking::Top(sample.processes, Ranking::Key::kCpu, kProcesses, top);
+  c.count[slot] = top.size();
+  ProcessTable const& processes = sample.processes;
+  for (size_t i = 0; i < top.size(); ++i) {
+    size_t index = top[i];
+    size_t row = slot * kProcesses + i;
+    c.pid[row] = processes.pid[index];
+    c.uid[row] = processes.uid[index];
+    c.process_cpu[row] = processes.cpu[index];
+    c.ram_kb[row] = processes.rss_kb[index];
+    c.process_uptime[row] = processes.uptime[index];
+    CopyString(c.command + row * kCommand, kCommand, processes.Command(index));
+  }
+  __atomic_store_n(&header_->end, tick + 1, __ATOMIC_RELEASE);
+}
+
+// The writer may overwrite the slot while it is copied, the tick is only
+// valid if it is still inside the ring afterwards
+bool History::Read(uint64_t tick, UserCache const& users, Sample& sample) const {
+  if (tick < First() || tick >= End()) { return false; }
+  Columns const& c = *columns_;
+  size_t slot = tick % header_->capacity;
+
+  sample.time = c.time[slot];
+  sample.os = header_->os;
+  sample.kernel = header_->kernel;
+  sample.cpu = c.cpu[slot];
+  sample.cores.clear();
+  sample.core_nodes.clear();
+  sample.nodes.clear();
+  sample.memory = c.memory[slot];
+  sample.swap = 0.0f;
+  sample.meminfo = MemInfo{};
+  sample.io = IoRates{};
+  sample.total_processes = c.total_processes[slot];
+  sample.running_processes = c.running_processes[slot];
+  sample.uptime = c.uptime[slot];
+  sample.cgroups.clear();
+  sample.threads.clear();
+  sample.timings.clear();
+  sample.self_cpu = 0.0f;
+  sample.cold_period = 1;
+  sample.backoff = 1;
+
+  uint32_t count = std::min(c.count[slot], kProcesses);
+  ProcessTable& processes = sample.processes;
+  processes.Clear();
+  for (size_t i = 0; i < count; ++i) {
+    size_t row = slot * kProcesses + i;
+    const char* command = c.command + row * kCommand;
+    size_t index = processes.Add(c.pid[row], c.uid[row], users.Name(c.uid[row]),
+                                 std::string_view(command, strnlen(command, kCommand)));
+    processes.cpu[index] = c.process_cpu[row];
+    processes.rss_kb[index] = c.ram_kb[row];
+    processes.uptime[index] = c.process_uptime[row];
+  }
+  processes.Index();
+
+  __atomic_thread_fence(__ATOMIC_ACQUIRE);
+  return tick + header_->capacity > End();
+}
+
+Producer ReplayProducer(History const& history, uint64_t tick) {
+  auto users = std::make_shared<UserCache>();
+  users->Refresh();
+  return [&history, tick, users](Sample& sample) mutable {
+    // a tick overwritten while reading moves the replay to the oldest one
+    for (int attempt = 0; attempt < 3; ++attempt) {
+      uint64_t end = history.End();
+      if (end == 0) { return; }
+      tick = std::min(std::max(tick, history.First()), end - 1);
+      if (history.Read(tick, *users, sample)) { break; }
+    }
+    if (tick + 1 < history.End()) { ++tick; }
+  };
+}
@@ -0,0 +1,106 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+
+#include "instrument.h"
+
+using std::uint64_t;
+
+namespace {
+
+const int kBuckets{256};
+const int kStages{int(Instrument::Stage::kCount)};
+
+struct Stats {
+  std::atomic<uint64_t> count{0};
+  std::atomic<uint64_t> total{0};  // nanoseconds
+  std::atomic<uint64_t> last{0};   // nanoseconds
+  std::atomic<uint64_t> buckets[kBuckets]{};
+};
+
+Stats stats[kStages];
+
+// Values below 8 get their own bucket, above that every power of two
+// is split into four: the two bits after the highest one select the bucket
+int Bucket(uint64_t value) {
+  if (value < 8) { return int(value); }
+  int high = 63 - __builtin_clzll(value);
+  return 4 * high + int((value >> (high - 2)) & 3) - 4;
+}
+
+double Midpoint(int bucket) {
+  if (bucket < 8) { return bucket; }
+  int high = bucket / 4 + 1;
+  uint64_t width = uint64_t(1) << (high - 2);
+  return double((4 + bucket % 4) * width) + width / 2.0;
+}
+
+// nearest rank of the fraction in a copy of the buckets holding count values:
+// the smallest value with at least that fraction of the values at or below
+// it, so p99 of few values is their maximum rather than their minimum
+double Percentile(uint64_t const (&buckets)[kBuckets], uint64_t count, double fraction) {
+  if (count == 0) { return 0.0; }
+  uint64_t rank = std::min<uint64_t>(uint64_t(std::ceil(fraction * count)), count);
+  rank = rank > 0 ? rank - 1 : 0;
+  uint64_t seen = 0;
+  for (int bucket = 0; bucket < kBuckets; ++bucket) {
+    seen += buckets[bucket];
+    if (seen > rank) { return Midpoint(bucket); }
+  }
+  return 0.0;
+}
+
+}  // namespace
+
+const char* Instrument::Name(Stage stage) {
+  switch (stage) {
+    case Stage::kPids: return "pids";
+    case Stage::kSystem: return "system";
+    case Stage::kUpdate: return "update";
+    case Stage::kNew: return "new";
+    case Stage::kCgroups: return "cgroups";
+    case Stage::kSmaps: return "smaps";
+    case Stage::kThreads: return "threads";
+    case Stage::kRank: return "rank";
+    case Stage::kOutput: return "output";
+    case Stage::kCount: break;
+  }
+  return "";
+}
+
+void Instrument::Record(Stage stage, std::chrono::nanoseconds duration) {
+  Stats& stage_stats = stats[int(stage)];
+  uint64_t nanoseconds = duration.count() > 0 ? duration.count() : 0;
+  stage_stats.count.fetch_add(1, std::memory_order_relaxed);
+  stage_stats.total.fetch_add(nanoseconds, std::memory_order_relaxed);
+  stage_stats.last.store(nanoseconds, std::memory_order_relaxed);
+  stage_stats.buckets[Bucket(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+}
+
+// The counters are read one by one while spans may still record,
+// a summary can be off by the measurement in flight
+void Instrument::Summarize(std::vector<Summary>& summaries) {
+  summaries.resize(kStages);
+  for (int i = 0; i < kStages; ++i) {
+    Stats const& stage = stats[i];
+    Summary& summary = summaries[i];
+    summary.name = Name(Stage(i));
+    summary.count = stage.count.load(std::memory_order_relaxed);
+    summary.last = stage.last.load(std::memory_order_relaxed) / 1000.0;
+    if (summary.count == 0) {
+      summary.mean = summary.p50 = summary.p99 = 0.0;
+      continue;
+    }
+    summary.mean = stage.total.load(std::memory_order_relaxed) / 1000.0 / summary.count;
+
+    uint64_t buckets[kBuckets];
+    uint64_t counted = 0;
+    for (int bucket = 0; bucket < kBuckets; ++bucket) {
+      buckets[bucket] = stage.buckets[bucket].load(std::memory_order_relaxed);
+      counted += buckets[bucket];
+    }
+    summary.p50 = Percentile(buckets, counted, 0.50) / 1000.0;
+    summary.p99 = Percentile(buckets, counted, 0.99) / 1000.0;
+  }
+}
@@ -1,58 +1,50 @@
 #include <dirent.h>
 #include <unistd.h>
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <fstream>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <vector>
-#include <iostream>
-#include <experimental/filesystem>
 
 #include "linux_parser.h"
 
-using std::stof;
 using std::string;
-using std::to_string;
 using std::vector;
 
-// generic functions for parsing 
-template <typename T>
-T findValueByKey (string const &keyFilter, string const &file) {
-  string line, key;
-  T value;
+static std::string& ProcRoot() {
+  static std::string root{LinuxParser::kProcDirectory};
+  return root;
+}
 
-  std::ifstream stream(LinuxParser::kProcDirectory + file);
-  if (stream.is_open()) {
-    while (std::getline(stream, line)) {
-      std::istringstream linestream(line);
-      while (linestream >> key >> value) {
-        if (key == keyFilter) {
-          return value;
-        }
-      }
-    }
-  }
-  return value;
-};
+std::string const& LinuxParser::ProcDirectory() { return ProcRoot(); }
 
-template <typename T>
-T getValueOfFile( string const &file) {
-  string line;
-  T value;
+// keep the trailing slash of kProcDirectory
+void LinuxParser::SetProcDirectory(std::string directory) {
+  if (directory.empty() || directory.back() != '/') { directory += '/'; }
+  ProcRoot() = std::move(directory);
+}
 
-  std::ifstream stream(LinuxParser::kProcDirectory + file);
-    if (stream.is_open()) {
-      std::getline(stream, line);
-      std::istringstream linestream(line);
-      linestream >> value;
-    }
-  return value;
-};
+// generic functions for parsing
+// every thread reuses its own buffer, so reading a file does not allocate
+static ProcParser::Buffer& ReadBuffer() {
+  thread_local ProcParser::Buffer buffer;
+  return buffer;
+}
 
+// read a file below the proc directory, empty view if it can not be read
+static std::string_view ReadProcFile(std::string_view file) {
+  ProcParser::Buffer& buffer = ReadBuffer();
+  ProcParser::ReadFile(ProcParser::Path(LinuxParser::ProcDirectory(), file).c_str(), buffer);
+  return buffer.View();
+}
 
-// helper function to determine whether string is only digits 
-bool LinuxParser::is_number(const std::string& s) {
-    std::string::const_iterator it = s.begin();
-    while (it != s.end() && std::isdigit(*it)) ++it;
-    return !s.empty() && it == s.end();
+static std::string_view ReadPidFile(int pid, std::string_view file) {
+  ProcParser::Buffer& buffer = ReadBuffer();
+  ProcParser::ReadFile(ProcParser::Path(LinuxParser::ProcDirectory(), pid, file).c_str(), buffer);
+  return buffer.View();
 }
 
 // Read and return the system OS info
@@ -81,29 +73,41 @@ string LinuxParser::OperatingSystem() {
 
 // Read and return the Kernel info
 string LinuxParser::Kernel() {
-  string os, kernel, version;
-  string line;
-  std::ifstream stream(kProcDirectory + kVersionFilename);
-  if (stream.is_open()) {
-    std::getline(stream, line);
-    std::istringstream linestream(line);
-    linestream >> os >> version >> kernel;
+  // Linux version <kernel> ...
+  ProcParser::Scanner scanner(ReadProcFile(kVersionFilename));
+  scanner.SkipFields(2);
+  return string(scanner.Field());
+}
+
+// Find the cgroup2 line of mountinfo:
+// id parent major:minor root mount_point options [optional fields] - type source super_options
+string LinuxParser::CgroupDirectory() {
+  ProcParser::Scanner scanner(ReadProcFile(kMountinfoFilename));
+  while (!scanner.Done()) {
+    scanner.SkipFields(4);
+    std::string_view mount_point = scanner.Field();
+    for (auto field = scanner.Field(); !field.empty() && field != "-"; field = scanner.Field()) {}
+    if (scanner.Field() == "cgroup2") { return string(mount_point); }
+    scanner.SkipLine();
   }
-  return kernel;
+  return kCgroupDirectory;
 }
 
-// Read and return Pids 
-vector<int> LinuxParser::Pids() {
+// Names of the subdirectories that are numbers
+static vector<int> NumberedDirectories(const char* path) {
   vector<int> pids;
-  DIR* directory = opendir(kProcDirectory.c_str());
+  DIR* directory = opendir(path);
+  if (directory == nullptr) { return pids; }
   struct dirent* file;
   while ((file = readdir(directory)) != nullptr) {
     // Is this a directory?
     if (file->d_type == DT_DIR) {
       // Is every character of the name a digit?
-      string filename(file->d_name);
-      if (std::all_of(filename.begin(), filename.end(), isdigit)) {
-        int pid = stoi(filename);
+      const char* name = file->d_name;
+      const char* end = name + std::strlen(name);
+      int pid;
+      auto result = std::from_chars(name, end, pid);
+      if (result.ec == std::errc() && result.ptr == end) {
         pids.emplace_back(pid);
       }
     }
@@ -112,134 +116,115 @@ vector<int> LinuxParser::Pids() {
   return pids;
 }
 
-// Read and return the system memory utilization
-float LinuxParser::MemoryUtilization() { 
-  float memTotal = findValueByKey<float>(filterMemTotalString, kMeminfoFilename);
-  float memFree = findValueByKey<float>(filterMemFreeString, kMeminfoFilename);
-  float buffers = findValueByKey<float>(filterBufferString, kMeminfoFilename);
-  float cached = findValueByKey<float>(filterCachedString, kMeminfoFilename);
-  
-  return ((memTotal - memFree - buffers - cached) / memTotal); 
-}
+// Read and return Pids 
+vector<int> LinuxParser::Pids() { return NumberedDirectories(ProcDirectory().c_str()); }
 
-// Read and return the system uptime
-long LinuxParser::UpTime() {
-  return long(getValueOfFile<long>(kUptimeFilename));
+// /proc/<pid>/task has one directory per thread, the first is the pid itself
+vector<int> LinuxParser::Tasks(int pid) {
+  return NumberedDirectories(ProcParser::Path(ProcDirectory(), pid, kTaskDirectory).c_str());
 }
 
-// Read and return CPU utilization
-vector<string> LinuxParser::CpuUtilization() { 
-  string line;
-  vector<string> times{};
-
-  // read from proc stat file
-  std::ifstream filestream(kProcDirectory + kStatFilename);
-  if (filestream.is_open()) {
-    filestream.ignore(5, ' ');
-    //write each item after cpu into a vector
-    for (string time; filestream >> time; times.emplace_back(time));
+// Read the cpu list of every nodeN directory, e.g. "0-3,8-11"
+vector<int> LinuxParser::CpuNodes() {
+  vector<int> nodes;
+  DIR* directory = opendir(kNodeDirectory.c_str());
+  if (directory == nullptr) { return nodes; }
+  ProcParser::Buffer buffer;
+  struct dirent* file;
+  while ((file = readdir(directory)) != nullptr) {
+    const char* name = file->d_name;
+    const char* end = name + std::strlen(name);
+    int node;
+    if (std::strncmp(name, "node", 4) != 0) { continue; }
+    auto result = std::from_chars(name + 4, end, node);
+    if (result.ec != std::errc() || result.ptr != end) { continue; }
+    if (!ProcParser::ReadFile((kNodeDirectory + name + kCpulistFilename).c_str(), buffer)) { continue; }
+
+    std::string_view list = buffer.View();
+    const char* pos = list.data();
+    const char* last = list.data() + list.size();
+    int first, second;
+    while ((result = std::from_chars(pos, last, first)).ec == std::errc()) {
+      pos = result.ptr;
+      second = first;
+      if (pos < last && *pos == '-') {
+        result = std::from_chars(pos + 1, last, second);
+        if (result.ec != std::errc()) { break; }
+        pos = result.ptr;
+      }
+      if (first < 0 || second < first || second > 65535) { break; }
+      if (second >= int(nodes.size())) { nodes.resize(second + 1, -1); }
+      std::fill(nodes.begin() + first, nodes.begin() + second + 1, node);
+      if (pos == last || *pos != ',') { break; }
+      ++pos;
+    }
   }
-  return times; 
+  closedir(directory);
+  return nodes;
 }
 
-// Read and return the total number of processes
-int LinuxParser::TotalProcesses() { 
-  return findValueByKey<int>(filterProcesses, kStatFilename);
+// Read and return the command associated with a process
+// the arguments are separated by NUL characters
+string LinuxParser::Command(int pid) { 
+  string command(ReadPidFile(pid, kCmdlineFilename));
+  while (!command.empty() && command.back() == '\0') { command.pop_back(); }
+  std::replace(command.begin(), command.end(), '\0', ' ');
+  return command;
 }
 
-// Read and return the number of running processes
-int LinuxParser::RunningProcesses() { 
-  return findValueByKey<int>(filterRunningProcesses, kStatFilename);
+// Pss is shared pages divided among their users, the private ones are only this process's
+bool LinuxParser::SmapsRollup(int pid, long& pss_kb, long& uss_kb) {
+  std::string_view smaps = ReadPidFile(pid, kSmapsRollupFilename);
+  long clean{0}, dirty{0};
+  if (!ProcParser::FindValue(smaps, filterPss, pss_kb) ||
+      !ProcParser::FindValue(smaps, filterPrivateClean, clean) ||
+      !ProcParser::FindValue(smaps, filterPrivateDirty, dirty)) {
+    return false;
+  }
+  uss_kb = clean + dirty;
+  return true;
 }
 
-// Read and return the command associated with a process
-string LinuxParser::Command(int pid) { 
-  return string(getValueOfFile<string>(std::to_string(pid) + kCmdlineFilename));
+bool LinuxParser::TaskStat(int pid, int tid, ProcParser::PidStat& stat) {
+  ProcParser::Buffer& buffer = ReadBuffer();
+  ProcParser::ReadFile(ProcParser::Path(ProcDirectory(), pid, tid, kStatFilename).c_str(), buffer);
+  return ProcParser::ParsePidStat(buffer.View(), stat);
 }
 
-// Read and return the memory used by a process
-string LinuxParser::Ram(int pid) { 
-  string value;
-
-  // use VmRSS instead of VmSize to get exact physical memory instead of all virtual memory
-  double ram = findValueByKey<double>(filterProcMem, std::to_string(pid) + kStatusFilename);
-  
-  //convert from kB to MB
-  ram *= 0.001; 
+// comm ends with a newline
+string LinuxParser::TaskName(int pid, int tid) {
+  ProcParser::Buffer& buffer = ReadBuffer();
+  ProcParser::ReadFile(ProcParser::Path(ProcDirectory(), pid, tid, kCommFilename).c_str(), buffer);
+  std::string_view name = buffer.View();
+  while (!name.empty() && name.back() == '\n') { name.remove_suffix(1); }
+  return string(name);
+}
 
-  //format to be displayed with two decimals
-  value = std::to_string(ram);
-  value = value.substr(0, value.size()-4);
-  
-  return value;
- 
+bool LinuxParser::Io(int pid, ProcParser::PidIo& io) {
+  return ProcParser::ParsePidIo(ReadPidFile(pid, kIoFilename), io);
 }
 
 // Read and return the user ID associated with a process
-string LinuxParser::Uid(int pid) { 
-  return findValueByKey<string>(filterUID, std::to_string(pid) + kStatusFilename);
+// the real uid, -1 if the process is gone
+int LinuxParser::Uid(int pid) { 
+  int uid{-1};
+  ProcParser::FindValue(ReadPidFile(pid, kStatusFilename), filterUID, uid);
+  return uid;
 }
 
-// Read and return the user associated with a process
-string LinuxParser::User(int pid) {
-  string line;
-  string name{" "};
-  string password;
-  string uid;
-
-  // get the user id associated with the process
-  string find_uid = LinuxParser::Uid(pid);
-  
-  // use the uid to find the user name
-  std::ifstream filestream(kPasswordPath);
-  if (filestream.is_open()) {
-    while (std::getline(filestream, line)) {
-      std::replace(line.begin(), line.end(), ':', ' ');
-      std::istringstream linestream(line);
-      while(linestream >> name >> password >> uid) {
-        if (uid == find_uid) { return name; } 
-      }
-    }
-  }
-  return name; 
+// Read and parse the stat file of a process
+bool LinuxParser::Stat(int pid, ProcParser::PidStat& stat) {
+  return ProcParser::ParsePidStat(ReadPidFile(pid, kStatFilename), stat);
 }
 
-// Read and return the uptime of a process
-long LinuxParser::UpTime(int pid) { 
-  string line;
-  string value{};
-  int position = 22;
-  float uptime{0.0f};
-
-  // access the uptime file for the process
-  std::ifstream filestream(kProcDirectory + std::to_string(pid) + kStatFilename);
-    
-  if (filestream.is_open()) {
-      std::getline(filestream, line);
-      std::istringstream linestream(line);
-      for (auto i = 0; i < position; i++) {
-        linestream >> value;
-      }    
-  }
-  //convert lock ticks to seconds
-  if (LinuxParser::is_number(value)) { 
-    uptime = std::stof(value) / sysconf(_SC_CLK_TCK);
-    //substract process uptime from system uptime
-    return (LinuxParser::UpTime() - uptime); 
-  }
-
-  else { return uptime; }
+// Read and return the cgroup of a process, the "0::<path>" line of its cgroup file
+// cgroup v1 hierarchies have a controller between the colons and are skipped
+string LinuxParser::Cgroup(int pid) {
+  std::string_view text = ReadPidFile(pid, kCgroupFilename);
+  std::string_view unified = "0::";
+  std::size_t start = text.substr(0, unified.size()) == unified ? 0 : text.find("\n0::");
+  if (start == std::string_view::npos) { return string(); }
+  if (start > 0) { ++start; }
+  text = text.substr(start + unified.size());
+  return string(text.substr(0, text.find('\n')));
 }
-
-// Read and return the CPU times for the process
-vector<string> LinuxParser::CpuUtilization(int pid) {
-  string line;
-  vector<string> times{};
-
-  // read from proc stat file
-  std::ifstream filestream(kProcDirectory + std::to_string(pid) + kStatFilename);
-  if (filestream.is_open()) {
-    for (string time; filestream >> time; times.emplace_back(time));
-  }
-  return times; 
-}
\ No newline at end of file
@@ -1,7 +1,84 @@
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <functional>
+#include <memory>
+
+#include "collector.h"
+#include "history.h"
+#include "linux_parser.h"
 #include "ncurses_display.h"
+#include "options.h"
+#include "stream_writer.h"
 #include "system.h"
 
-int main() {
-  System system;
-  NCursesDisplay::Display(system);
-}
\ No newline at end of file
+// First recorded tick at the given local time of day, the most recent such time
+static std::uint64_t ReplayStart(History const& history, long time_of_day) {
+  if (time_of_day < 0 || history.End() == 0) { return history.First(); }
+  std::time_t now = std::time(nullptr);
+  std::tm local = *std::localtime(&now);
+  local.tm_hour = time_of_day / 3600;
+  local.tm_min = time_of_day / 60 % 60;
+  local.tm_sec = time_of_day % 60;
+  std::time_t start = std::mktime(&local);
+  if (start > now) { start -= 24 * 3600; }
+  return history.Find(start * 1000LL);
+}
+
+int main(int argc, char* argv[]) {
+  Options options = Options::Parse(argc, argv);
+  auto interval = std::chrono::milliseconds(options.interval);
+
+  std::unique_ptr<System> system;
+  std::unique_ptr<History> history;
+  Producer producer;
+  if (!options.replay.empty()) {
+    history = History::Open(options.replay);
+    if (!history) {
+      std::perror(options.replay.c_str());
+      return 1;
+    }
+    producer = ReplayProducer(*history, ReplayStart(*history, options.replay_at));
+  } else {
+    if (!options.proc.empty()) { LinuxParser::SetProcDirectory(options.proc); }
+    system = std::make_unique<System>(options.threads, options.events, options.budget, options.pss,
+                                      options.fds, options.uring);
+    // headless runs follow threads from the start, the display only while they are shown
+    if (options.headless) { system->ScanThreads(options.tasks); }
+    producer = LiveProducer(*system);
+    if (!options.history.empty()) {
+      history = History::Create(options.history, options.history_size);
+      if (!history) {
+        std::perror(options.history.c_str());
+        return 1;
+      }
+      producer = [live = std::move(producer), &history](Sample& sample) {
+        live(sample);
+        history->Append(sample);
+      };
+    }
+  }
+
+  if (options.headless) {
+    std::FILE* out = options.file.empty() ? stdout : std::fopen(options.file.c_str(), "wb");
+    if (out == nullptr) {
+      std::perror(options.file.c_str());
+      return 1;
+    }
+    StreamWriter writer(out, options.format);
+    writer.Stream(producer, interval, options.count);
+    return out == stdout ? 0 : std::fclose(out);
+  }
+
+  std::function<void(bool, int)> threads;
+  if (system) {
+    int processes = options.tasks > 0 ? options.tasks : 3;
+    threads = [&system, processes](bool shown, int pid) {
+      system->FollowThreads(shown ? pid : 0);
+      system->ScanThreads(shown ? processes : 0);
+    };
+  }
+  Collector collector(producer, interval);
+  NCursesDisplay::Display(collector, 10, std::chrono::milliseconds(options.redraw),
+                          options.sort, threads);
+}
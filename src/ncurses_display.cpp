@@ -1,112 +1,468 @@
 #include <curses.h>
+#include <algorithm>
+#include <cctype>
+#include <charconv>
 #include <chrono>
+#include <cstdio>
+#include <cstdlib>
 #include <string>
-#include <thread>
+#include <string_view>
 #include <vector>
 
+#include "canvas.h"
 #include "format.h"
+#include "instrument.h"
 #include "ncurses_display.h"
 #include "system.h"
 
-using std::string;
-using std::to_string;
+using std::string_view;
+
+// Percent as the first characters of to_string(percent * 100)
+static string_view Percent(float percent, char* buffer, std::size_t length) {
+  int written = std::snprintf(buffer, length + 1, "%f", percent * 100);
+  return string_view(buffer, std::max(0, std::min(written, int(length))));
+}
 
 // 50 bars uniformly displayed from 0 - 100 %
 // 2% is one bar(|)
-std::string NCursesDisplay::ProgressBar(float percent) {
-  std::string result{"0%"};
+string_view NCursesDisplay::ProgressBar(float percent, char (&buffer)[64]) {
   int size{50};
   float bars{percent * size};
+  std::size_t length{0};
 
+  buffer[length++] = '0';
+  buffer[length++] = '%';
   for (int i{0}; i < size; ++i) {
-    result += i <= bars ? '|' : ' ';
+    buffer[length++] = i <= bars ? '|' : ' ';
+  }
+  buffer[length++] = ' ';
+  if (percent < 0.1 || percent == 1.0) {
+    buffer[length++] = ' ';
+    length += Percent(percent, buffer + length, 3).size();
+  } else {
+    length += Percent(percent, buffer + length, 4).size();
+  }
+  for (char c : string_view("/100%")) { buffer[length++] = c; }
+  return string_view(buffer, length);
+}
+
+// One cell per core from row, col on, a line per NUMA node wrapping onto
+// the next rows, darker to brighter and blue to red with the load
+void NCursesDisplay::DisplayCores(Sample const& sample, Canvas& canvas, int first_row, int col) {
+  static const string_view levels{".:-=+*#%@"};
+  char label[16];
+  int const last_row{canvas.Rows() - 2};
+  int const width{canvas.Cols() - 1 - col};
+  if (width < kCoresWidth) { return; }
+  int row{first_row};
+  for (std::size_t node = 0; node < sample.nodes.size() && row <= last_row; ++node) {
+    int length = std::snprintf(label, sizeof(label), "N%zu %3.0f%% ", node, sample.nodes[node] * 100);
+    int start = canvas.Put(row, col, string_view(label, std::max(0, std::min(length, int(sizeof(label) - 1)))),
+                           COLOR_PAIR(2));
+    int cell{start};
+    for (std::size_t core = 0; core < sample.cores.size(); ++core) {
+      if (sample.core_nodes[core] != int(node)) { continue; }
+      if (cell >= col + width) {
+        if (++row > last_row) { break; }
+        cell = start;
+      }
+      float load = std::clamp(sample.cores[core], 0.0f, 1.0f);
+      int level = std::min(int(load * levels.size()), int(levels.size()) - 1);
+      chtype color = load < 0.5f ? COLOR_PAIR(1) : load < 0.8f ? COLOR_PAIR(3) : COLOR_PAIR(4);
+      canvas.Put(row, cell++, levels.substr(level, 1), color);
+    }
+    ++row;
+  }
+}
+
+void NCursesDisplay::DisplaySystem(Sample const& sample, Canvas& canvas) {
+  char buffer[64];
+  int row{0};
+  auto line = [&canvas, &row](string_view label, string_view value) {
+    ++row;
+    canvas.Put(row, canvas.Put(row, 2, label), value);
+  };
+  auto number = [&buffer](long value) {
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    return string_view(buffer, result.ptr - buffer);
+  };
+
+  canvas.Clear();
+  line("OS: ", sample.os);
+  line("Kernel: ", sample.kernel);
+  canvas.Put(++row, 2, "CPU: ");
+  canvas.Put(row, 10, ProgressBar(sample.cpu, buffer), COLOR_PAIR(1));
+  canvas.Put(++row, 2, "Memory: ");
+  canvas.Put(row, 10, ProgressBar(sample.memory, buffer), COLOR_PAIR(1));
+  canvas.Put(++row, 2, "Swap: ");
+  canvas.Put(row, 10, ProgressBar(sample.swap, buffer), COLOR_PAIR(1));
+  // used is what MemAvailable leaves, the page cache and slab are mostly reclaimable
+  MemInfo const& memory = sample.meminfo;
+  unsigned long long used = memory.total - std::min(memory.available, memory.total);
+  int length = std::snprintf(buffer, sizeof(buffer), "used %llu  cache %llu  slab %llu  swap %llu MB",
+                             used / 1024, (memory.cached + memory.buffers) / 1024,
+                             (memory.slab_reclaimable + memory.slab_unreclaimable) / 1024,
+                             (memory.swap_total - std::min(memory.swap_free, memory.swap_total)) / 1024);
+  canvas.Put(++row, 10, string_view(buffer, std::max(0, std::min(length, int(sizeof(buffer) - 1)))));
+  // disk and network per second, each rate formatted into its own part of the buffer
+  char rates[4][16];
+  IoRates const& io = sample.io;
+  float const values[4] = {io.disk_read, io.disk_write, io.net_receive, io.net_send};
+  for (int i = 0; i < 4; ++i) { rates[i][Format::Rate(values[i], rates[i], sizeof(rates[i]))] = '\0'; }
+  length = std::snprintf(buffer, sizeof(buffer), "disk %s/%s  net %s/%s B/s (in/out)", rates[0], rates[1],
+                         rates[2], rates[3]);
+  canvas.Put(++row, 2, "I/O: ");
+  canvas.Put(row, 10, string_view(buffer, std::max(0, std::min(length, int(sizeof(buffer) - 1)))));
+  line("Total Processes: ", number(sample.total_processes));
+  line("Running Processes: ", number(sample.running_processes));
+  line("Up Time: ", string_view(buffer, Format::ElapsedTime(sample.uptime, buffer, sizeof(buffer))));
+  // behind the progress bars, or right of the short lines at the bottom
+  // when the window is too narrow for that
+  int const bars_end{10 + int(ProgressBar(1.0f, buffer).size())};
+  if (canvas.Cols() - 1 - (bars_end + 3) >= kCoresWidth) {
+    DisplayCores(sample, canvas, 1, bars_end + 3);
+  } else {
+    DisplayCores(sample, canvas, row - 2, 32);
+  }
+}
+
+// Start of every column of the process list, -1 for a hidden one
+struct ProcessColumns {
+  int pid{2};
+  int user{9};
+  int cpu{16};
+  int ram{24};
+  int pss{-1};
+  int read{-1};
+  int write{-1};
+  int syscalls{-1};
+  int time{-1};
+  int command{-1};
+};
+
+// The columns left of COMMAND that fit into width while COMMAND keeps at
+// least kCommandWidth cells; PSS only once smaps_rollup was read at all.
+// The optional ones go in the order SYSC/s, WRITE/s, READ/s, PSS
+static ProcessColumns Layout(int width, bool pss) {
+  static const int kCommandWidth{16};
+  int const optional[4] = {pss ? 9 : 0, 8, 8, 8};  // PSS, READ/s, WRITE/s, SYSC/s
+  int shown{4};
+  int end{33 + optional[0] + optional[1] + optional[2] + optional[3] + 10};
+  while (shown > 0 && end + kCommandWidth > width - 1) { end -= optional[--shown]; }
+  ProcessColumns columns;
+  int col{33};
+  int* const starts[4] = {&columns.pss, &columns.read, &columns.write, &columns.syscalls};
+  for (int i = 0; i < shown; ++i) {
+    if (optional[i] == 0) { continue; }
+    *starts[i] = col;
+    col += optional[i];
   }
+  columns.time = col;
+  columns.command = col + 10;
+  return columns;
+}
 
-  string display{to_string(percent * 100).substr(0, 4)};
-  if (percent < 0.1 || percent == 1.0)
-    display = " " + to_string(percent * 100).substr(0, 3);
-  return result + " " + display + "/100%";
+// rows: indices into processes in display order, selected is shown reversed
+// only these rows are formatted, straight from the columns
+void NCursesDisplay::DisplayProcesses(ProcessTable const& processes,
+                                      std::vector<std::size_t> const& rows,
+                                      Canvas& canvas, int n, std::size_t selected) {
+  static const string_view blank{"                                                                "};
+  char buffer[64];
+  int row{0};
+  bool const pss = std::any_of(processes.pss_kb.begin(), processes.pss_kb.end(), [](long kb) { return kb >= 0; });
+  ProcessColumns const columns = Layout(canvas.Cols(), pss);
+  // a value of a hidden column is not drawn
+  auto put = [&canvas, &row](int col, string_view text, chtype attributes) {
+    if (col >= 0) { canvas.Put(row, col, text, attributes); }
+  };
+  canvas.Clear();
+  ++row;
+  put(columns.pid, "PID", COLOR_PAIR(2));
+  put(columns.user, "USER", COLOR_PAIR(2));
+  put(columns.cpu, "CPU[%]", COLOR_PAIR(2));
+  put(columns.ram, "RAM[MB]", COLOR_PAIR(2));
+  put(columns.pss, "PSS[MB]", COLOR_PAIR(2));
+  put(columns.read, "READ/s", COLOR_PAIR(2));
+  put(columns.write, "WRITE/s", COLOR_PAIR(2));
+  put(columns.syscalls, "SYSC/s", COLOR_PAIR(2));
+  put(columns.time, "TIME+", COLOR_PAIR(2));
+  put(columns.command, "COMMAND", COLOR_PAIR(2));
+  for (int i = 0; i < n && i < int(rows.size()); ++i) {
+    std::size_t index = rows[i];
+    // the selected row is reversed across the whole line
+    chtype attributes = index == selected ? A_REVERSE : A_NORMAL;
+    ++row;
+    if (index == selected) {
+      for (int col = 1; col < canvas.Cols() - 1; col += blank.size()) { canvas.Put(row, col, blank, attributes); }
+    }
+    auto pid = std::to_chars(buffer, buffer + sizeof(buffer), processes.pid[index]);
+    put(columns.pid, string_view(buffer, pid.ptr - buffer), attributes);
+    put(columns.user, processes.User(index), attributes);
+    put(columns.cpu, Percent(processes.cpu[index], buffer, 4), attributes);
+    put(columns.ram, string_view(buffer, Format::Megabytes(processes.rss_kb[index], buffer, sizeof(buffer))),
+        attributes);
+    // blank until smaps_rollup was read
+    if (processes.pss_kb[index] >= 0) {
+      put(columns.pss, string_view(buffer, Format::Megabytes(processes.pss_kb[index], buffer, sizeof(buffer))),
+          attributes);
+    }
+    // blank where the io file can not be read
+    if (processes.read_rate[index] >= 0.0f) {
+      put(columns.read, string_view(buffer, Format::Rate(processes.read_rate[index], buffer, sizeof(buffer))),
+          attributes);
+      put(columns.write, string_view(buffer, Format::Rate(processes.write_rate[index], buffer, sizeof(buffer))),
+          attributes);
+      put(columns.syscalls,
+          string_view(buffer, Format::Rate(processes.syscall_rate[index], buffer, sizeof(buffer))), attributes);
+    }
+    put(columns.time, string_view(buffer, Format::ElapsedTime(processes.uptime[index], buffer, sizeof(buffer))),
+        attributes);
+    put(columns.command, processes.Command(index), attributes);
+  }
 }
 
-void NCursesDisplay::DisplaySystem(System& system, WINDOW* window) {
+// The cgroup tree in place of the processes, a child indented below its parent
+// with the last part of its path
+void NCursesDisplay::DisplayCgroups(std::vector<CgroupUsage> const& cgroups, Canvas& canvas, int n) {
+  char buffer[64];
   int row{0};
-  mvwprintw(window, ++row, 2, ("OS: " + system.OperatingSystem()).c_str());
-  mvwprintw(window, ++row, 2, ("Kernel: " + system.Kernel()).c_str());
-  mvwprintw(window, ++row, 2, "CPU: ");
-  wattron(window, COLOR_PAIR(1));
-  mvwprintw(window, row, 10, "");
-  wprintw(window, ProgressBar(system.Cpu().Utilization()).c_str());
-  wattroff(window, COLOR_PAIR(1));
-  mvwprintw(window, ++row, 2, "Memory: ");
-  wattron(window, COLOR_PAIR(1));
-  mvwprintw(window, row, 10, "");
-  wprintw(window, ProgressBar(system.MemoryUtilization()).c_str());
-  wattroff(window, COLOR_PAIR(1));
-  mvwprintw(window, ++row, 2,
-            ("Total Processes: " + to_string(system.TotalProcesses())).c_str());
-  mvwprintw(
-      window, ++row, 2,
-      ("Running Processes: " + to_string(system.RunningProcesses())).c_str());
-  mvwprintw(window, ++row, 2,
-            ("Up Time: " + Format::ElapsedTime(system.UpTime())).c_str());
-  wrefresh(window);
+  int const cpu_column{2};
+  int const memory_column{10};
+  int const processes_column{21};
+  int const cgroup_column{29};
+  canvas.Clear();
+  canvas.Put(++row, cpu_column, "CPU[%]", COLOR_PAIR(2));
+  canvas.Put(row, memory_column, "MEM[MB]", COLOR_PAIR(2));
+  canvas.Put(row, processes_column, "PROCS", COLOR_PAIR(2));
+  canvas.Put(row, cgroup_column, "CGROUP", COLOR_PAIR(2));
+  for (int i = 0; i < n && i < int(cgroups.size()); ++i) {
+    CgroupUsage const& cgroup = cgroups[i];
+    canvas.Put(++row, cpu_column, Percent(cgroup.cpu, buffer, 4));
+    canvas.Put(row, memory_column,
+               string_view(buffer, Format::Megabytes(cgroup.memory_kb, buffer, sizeof(buffer))));
+    auto processes = std::to_chars(buffer, buffer + sizeof(buffer), cgroup.processes);
+    canvas.Put(row, processes_column, string_view(buffer, processes.ptr - buffer));
+    string_view name(cgroup.path);
+    if (cgroup.depth > 0) { name.remove_prefix(name.rfind('/') + 1); }
+    canvas.Put(row, cgroup_column + 2 * cgroup.depth, name);
+  }
 }
 
-void NCursesDisplay::DisplayProcesses(std::vector<Process>& processes,
-                                      WINDOW* window, int n) {
+// The busiest threads of the followed processes in place of the processes
+void NCursesDisplay::DisplayThreads(std::vector<ThreadUsage> const& threads, Canvas& canvas, int n) {
+  char buffer[64];
   int row{0};
-  int const pid_column{2};
-  int const user_column{9};
-  int const cpu_column{16};
-  int const ram_column{26};
-  int const time_column{35};
-  int const command_column{46};
-  wattron(window, COLOR_PAIR(2));
-  mvwprintw(window, ++row, pid_column, "PID");
-  mvwprintw(window, row, user_column, "USER");
-  mvwprintw(window, row, cpu_column, "CPU[%%]");
-  mvwprintw(window, row, ram_column, "RAM[MB]");
-  mvwprintw(window, row, time_column, "TIME+");
-  mvwprintw(window, row, command_column, "COMMAND");
-  wattroff(window, COLOR_PAIR(2));
-  for (int i = 0; i < n; ++i) {
-    // Clear the line
-    mvwprintw(window, ++row, pid_column, (string(window->_maxx-2, ' ').c_str()));
-    
-    mvwprintw(window, row, pid_column, to_string(processes[i].Pid()).c_str());
-    mvwprintw(window, row, user_column, processes[i].User().c_str());
-    float cpu = processes[i].CpuUtilization() * 100;
-    mvwprintw(window, row, cpu_column, to_string(cpu).substr(0, 4).c_str());
-    mvwprintw(window, row, ram_column, processes[i].Ram().c_str());
-    mvwprintw(window, row, time_column,
-              Format::ElapsedTime(processes[i].UpTime()).c_str());
-    mvwprintw(window, row, command_column,
-              processes[i].Command().substr(0, window->_maxx - 46).c_str());
+  int const tid_column{2};
+  int const pid_column{10};
+  int const cpu_column{18};
+  int const name_column{26};
+  canvas.Clear();
+  canvas.Put(++row, tid_column, "TID", COLOR_PAIR(2));
+  canvas.Put(row, pid_column, "PID", COLOR_PAIR(2));
+  canvas.Put(row, cpu_column, "CPU[%]", COLOR_PAIR(2));
+  canvas.Put(row, name_column, "THREAD", COLOR_PAIR(2));
+  for (int i = 0; i < n && i < int(threads.size()); ++i) {
+    ThreadUsage const& thread = threads[i];
+    auto tid = std::to_chars(buffer, buffer + sizeof(buffer), thread.tid);
+    canvas.Put(++row, tid_column, string_view(buffer, tid.ptr - buffer));
+    auto pid = std::to_chars(buffer, buffer + sizeof(buffer), thread.pid);
+    canvas.Put(row, pid_column, string_view(buffer, pid.ptr - buffer));
+    canvas.Put(row, cpu_column, Percent(thread.cpu, buffer, 4));
+    canvas.Put(row, name_column, thread.name);
+  }
+}
+
+// Per stage cost of the monitor itself, in microseconds, and its CPU budget
+void NCursesDisplay::DisplayTimings(Sample const& sample, std::vector<Instrument::Summary> const& timings,
+                                    Canvas& canvas) {
+  char buffer[96];
+  int row{0};
+  canvas.Clear();
+  canvas.Put(++row, 2, "STAGE      CALLS     LAST     MEAN      P50      P99 [us]", COLOR_PAIR(2));
+  for (Instrument::Summary const& timing : timings) {
+    int length = std::snprintf(buffer, sizeof(buffer), "%-8s%9llu%9.0f%9.0f%9.0f%9.0f", timing.name,
+                               timing.count, timing.last, timing.mean, timing.p50, timing.p99);
+    canvas.Put(++row, 2, string_view(buffer, std::max(0, std::min(length, int(sizeof(buffer) - 1)))));
+  }
+  int length = std::snprintf(buffer, sizeof(buffer), "self %.1f%% CPU, idle every %d ticks, interval x%d",
+                             sample.self_cpu * 100, sample.cold_period, sample.backoff);
+  canvas.Put(++row, 2, string_view(buffer, std::max(0, std::min(length, int(sizeof(buffer) - 1)))));
+}
+
+// Keys of the process list and the prompt being typed, on the last line of its window
+static void DisplayStatus(Canvas& canvas, Ranking::Key key, ProcessFilter const& filter, std::size_t shown,
+                          std::size_t total, int follow, bool found, char prompt, std::string const& typed,
+                          bool invalid) {
+  char buffer[160];
+  int length;
+  if (prompt == '/') {
+    length = std::snprintf(buffer, sizeof(buffer), "filter (regex on user or command): %s_%s", typed.c_str(),
+                           invalid ? "  invalid" : "");
+  } else if (prompt == 'g') {
+    length = std::snprintf(buffer, sizeof(buffer), "go to pid: %s_", typed.c_str());
+  } else {
+    char filtered[96] = "";
+    if (!filter.Empty()) {
+      std::snprintf(filtered, sizeof(filtered), "  /%s/ %zu of %zu", filter.Pattern().c_str(), shown, total);
+    }
+    char followed[48] = "";
+    if (follow > 0) { std::snprintf(followed, sizeof(followed), "  pid %d%s", follow, found ? "" : " not listed"); }
+    length = std::snprintf(buffer, sizeof(buffer), "sort %s%s%s  [s]ort [/]filter [g]o to pid [esc]",
+                           Ranking::Name(key), filtered, followed);
   }
+  canvas.Put(canvas.Rows() - 2, 2, string_view(buffer, std::max(0, std::min(length, int(sizeof(buffer) - 1)))),
+             COLOR_PAIR(2));
 }
 
-void NCursesDisplay::Display(System& system, int n) {
+// Render the newest sample of the collector
+// sampling runs on the collector thread, this loop only draws when a new
+// sample arrived and otherwise waits up to the redraw interval for a key
+// the canvases only pass changed cells on, and one doupdate() per frame
+// sends them to the terminal
+// 'i' toggles an overlay with the monitor's own timings on top of the processes
+// 'c' switches the lower window between the processes and the cgroup tree,
+// 't' between the processes and their busiest threads, the followed pid's
+// first; threads are only scanned while shown, and not at all without a
+// threads callback (replay)
+// 's' and 'S' step through the sort keys, '/' types a filter that applies
+// with every key, 'g' a pid whose page is then followed, escape drops both;
+// all of it is answered from the sample on screen through the table's
+// indexes and the filter's cache, nothing waits for the next refresh
+void NCursesDisplay::Display(Collector& collector, int n,
+                             std::chrono::milliseconds redraw, Ranking::Key key,
+                             std::function<void(bool, int)> threads) {
   initscr();      // start ncurses
-  noecho();       // do not print input values
+  noecho();       // do not print typed values
   cbreak();       // terminate ncurses on ctrl + c
   start_color();  // enable color
+  init_pair(1, COLOR_BLUE, COLOR_BLACK);
+  init_pair(2, COLOR_GREEN, COLOR_BLACK);
+  init_pair(3, COLOR_YELLOW, COLOR_BLACK);
+  init_pair(4, COLOR_RED, COLOR_BLACK);
 
   int x_max{getmaxx(stdscr)};
-  WINDOW* system_window = newwin(9, x_max - 1, 0, 0);
+  WINDOW* system_window = newwin(12, x_max - 1, 0, 0);
   WINDOW* process_window =
-      newwin(3 + n, x_max - 1, system_window->_maxy + 1, 0);
+      newwin(4 + n, x_max - 1, system_window->_maxy + 1, 0);
+  wtimeout(process_window, redraw.count());
+  keypad(process_window, TRUE);
+  set_escdelay(25);
+  int const overlay_width{60};
+  WINDOW* overlay_window = newwin(4 + int(Instrument::Stage::kCount), overlay_width,
+                                  system_window->_maxy + 2, std::max(0, x_max - overlay_width - 2));
+  Canvas system_canvas(system_window);
+  Canvas process_canvas(process_window);
+  Canvas overlay_canvas(overlay_window);
 
+  unsigned long drawn{0};
+  bool overlay{false};
+  enum class View { kProcesses, kCgroups, kThreads } view{View::kProcesses};
+  std::vector<std::size_t> rows;
+  std::vector<std::size_t> listed;
+  std::vector<Instrument::Summary> timings;
+  ProcessFilter filter;
+  std::string previous;  // filter before the prompt, restored by escape
+  std::string typed;     // text of the prompt
+  char prompt{0};        // '/' or 'g' while typing
+  bool invalid{false};
+  int follow{0};         // pid whose page is shown, 0 for the first page
   while (1) {
-    init_pair(1, COLOR_BLUE, COLOR_BLACK);
-    init_pair(2, COLOR_GREEN, COLOR_BLACK);
-    box(system_window, 0, 0);
-    box(process_window, 0, 0);
-    DisplaySystem(system, system_window);
-    DisplayProcesses(system.Processes(), process_window, n);
-    wrefresh(system_window);
-    wrefresh(process_window);
-    refresh();
-    std::this_thread::sleep_for(std::chrono::seconds(1));
+    Sample const& sample = collector.Latest();
+    if (sample.sequence != drawn) {
+      // the page is cut from the filtered order, the one holding the followed pid
+      ProcessTable const& processes = sample.processes;
+      filter.Apply(processes, Ranking::Order(processes, key), listed);
+      Ranking::Cursor const cursor = Ranking::Follow(processes, key, listed, follow, n);
+      Ranking::Page(processes, key, listed, cursor.first, n, rows);
+      Instrument::Span span(Instrument::Stage::kOutput);
+      DisplaySystem(sample, system_canvas);
+      if (view == View::kCgroups) {
+        DisplayCgroups(sample.cgroups, process_canvas, n);
+      } else if (view == View::kThreads) {
+        DisplayThreads(sample.threads, process_canvas, n);
+      } else {
+        DisplayProcesses(processes, rows, process_canvas, n, cursor.selected);
+        DisplayStatus(process_canvas, key, filter, listed.size(), processes.Size(), follow, cursor.found, prompt,
+                      typed, invalid);
+      }
+      system_canvas.Flush();
+      process_canvas.Flush();
+      if (overlay) {
+        // copy the whole overlay again, the rows below may have changed the same cells
+        Instrument::Summarize(timings);
+        DisplayTimings(sample, timings, overlay_canvas);
+        touchwin(overlay_window);
+        overlay_canvas.Flush();
+      }
+      doupdate();
+      drawn = sample.sequence;
+    }
+    int input = wgetch(process_window);
+    if (input == ERR) { continue; }
+    if (prompt != 0) {
+      // typing: every key edits the line, the filter applies as it is typed
+      if (input == 27) {
+        if (prompt == '/') { filter.Set(previous); }
+        prompt = 0;
+      } else if (input == '\n' || input == KEY_ENTER) {
+        if (prompt == 'g') {
+          follow = std::atoi(typed.c_str());
+          // a filter hiding the pid would hide the jump
+          if (follow > 0) { filter.Set(""); }
+        }
+        prompt = 0;
+      } else if (input == KEY_BACKSPACE || input == 127 || input == 8) {
+        if (!typed.empty()) { typed.pop_back(); }
+      } else if (input >= ' ' && input < 127 && (prompt == '/' || std::isdigit(input))) {
+        typed.push_back(char(input));
+      }
+      if (prompt == '/') { invalid = !filter.Set(typed); }
+      drawn = 0;
+      continue;
+    }
+    if (input == 'q') { break; }
+    if (input == 's' || input == 'S') {
+      int count = int(Ranking::Key::kCount);
+      key = Ranking::Key((int(key) + (input == 's' ? 1 : count - 1)) % count);
+      drawn = 0;
+    }
+    if (input == '/' || input == 'g') {
+      prompt = char(input);
+      previous = filter.Pattern();
+      typed = prompt == '/' ? previous : std::string();
+      invalid = false;
+      if (threads && view == View::kThreads) { threads(false, 0); }
+      view = View::kProcesses;
+      drawn = 0;
+    }
+    if (input == 27) {
+      filter.Set("");
+      follow = 0;
+      if (threads && view == View::kThreads) { threads(true, 0); }
+      drawn = 0;
+    }
+    if (input == 'i') {
+      // uncover the windows below by copying all of their cells again
+      overlay = !overlay;
+      if (!overlay) {
+        touchwin(system_window);
+        touchwin(process_window);
+      }
+      drawn = 0;
+    }
+    if (input == 'c' || (input == 't' && threads)) {
+      View next = input == 'c' ? View::kCgroups : View::kThreads;
+      next = view == next ? View::kProcesses : next;
+      if (threads && (view == View::kThreads) != (next == View::kThreads)) {
+        threads(next == View::kThreads, follow);
+      }
+      view = next;
+      drawn = 0;
+    }
   }
+  delwin(overlay_window);
+  delwin(process_window);
+  delwin(system_window);
   endwin();
 }
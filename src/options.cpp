@@ -0,0 +1,154 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "options.h"
+
+using std::string;
+
+static void Usage(const char* program) {
+  std::cerr << "usage: " << program << " [options]\n"
+            << "  -j, --threads N   worker threads scanning /proc (default: cores, at most 8)\n"
+            << "  -i, --interval MS sampling interval in milliseconds (default: 1000)\n"
+            << "  -r, --redraw MS   redraw and key polling interval in milliseconds (default: 100)\n"
+            << "  -s, --sort KEY    order processes by cpu, ram, pid, time, user, read, write\n"
+            << "                    or syscalls (default: cpu, 's' changes it while running)\n"
+            << "  -b, --budget PCT  keep the monitor below PCT percent of one core by reading\n"
+            << "                    idle processes less often and stretching the interval\n"
+            << "  -e, --events      follow processes through the kernel proc connector (needs root);\n"
+            << "                    one that starts and exits between samples is shown once, and\n"
+            << "                    only if its parent has not reaped it yet\n"
+            << "  --pss N           read PSS and USS of the N processes with the most RSS\n"
+            << "                    from smaps_rollup, each at most every 5 samples\n"
+            << "  --tasks N         follow the threads of the N processes with the most CPU\n"
+            << "                    (default: 3 while the thread view is open)\n"
+            << "  --fds N           keep up to N stat and N io files open across samples and\n"
+            << "                    re-read them in place, 0 to open them for every read (default: 1024)\n"
+            << "  --uring           read the stat and io files in batches through io_uring, one\n"
+            << "                    syscall per batch instead of per file; falls back if unavailable\n"
+            << "  --proc DIR        read processes from DIR instead of /proc\n"
+            << "  -o, --output FMT  stream samples as json, csv or binary instead of drawing\n"
+            << "  -f, --file PATH   write the stream to PATH instead of stdout\n"
+            << "  -n, --count N     stop after N samples (default: unlimited)\n"
+            << "  --history PATH    record every sample into the ring file PATH\n"
+            << "  --history-size N  ticks kept in the history ring (default: 3600)\n"
+            << "  --replay PATH     show the samples recorded in PATH instead of the live system\n"
+            << "  --at HH:MM[:SS]   start the replay at this local time (default: oldest tick)\n"
+            << "  -h, --help        show this help\n";
+}
+
+[[noreturn]] static void Fail(const char* program) {
+  Usage(program);
+  std::exit(1);
+}
+
+// Match "-s value", "--long value" or "--long=value" at argv[i]
+// the value is stored in value, a missing value is an error
+static bool Match(int& i, int argc, char* argv[], const char* short_name,
+                  const char* long_name, const char*& value) {
+  const char* arg = argv[i];
+  std::size_t length = std::strlen(long_name);
+  if ((*short_name && std::strcmp(arg, short_name) == 0) || std::strcmp(arg, long_name) == 0) {
+    if (i + 1 >= argc) { Fail(argv[0]); }
+    value = argv[++i];
+    return true;
+  }
+  if (std::strncmp(arg, long_name, length) == 0 && arg[length] == '=') {
+    value = arg + length + 1;
+    return true;
+  }
+  return false;
+}
+
+// Positive integer option value
+static int Number(const char* value, const char* program) {
+  char* end = nullptr;
+  long number = std::strtol(value, &end, 10);
+  if (*end != '\0' || number <= 0) { Fail(program); }
+  return int(number);
+}
+
+// Non-negative integer option value, for counts where 0 turns a feature off
+static int Count(const char* value, const char* program) {
+  char* end = nullptr;
+  long number = std::strtol(value, &end, 10);
+  if (end == value || *end != '\0' || number < 0) { Fail(program); }
+  return int(number);
+}
+
+// Positive percentage as a fraction
+static double Fraction(const char* value, const char* program) {
+  char* end = nullptr;
+  double percent = std::strtod(value, &end);
+  if (*end != '\0' || !(percent > 0.0)) { Fail(program); }
+  return percent / 100.0;
+}
+
+// HH:MM or HH:MM:SS as seconds after midnight
+static long TimeOfDay(const char* value, const char* program) {
+  int hours{0}, minutes{0}, seconds{0};
+  int fields = std::sscanf(value, "%d:%d:%d", &hours, &minutes, &seconds);
+  if (fields < 2 || hours < 0 || hours > 23 || minutes < 0 || minutes > 59 || seconds < 0 ||
+      seconds > 59) {
+    Fail(program);
+  }
+  return hours * 3600L + minutes * 60L + seconds;
+}
+
+Options Options::Parse(int argc, char* argv[]) {
+  Options options;
+  options.threads = std::clamp(int(std::thread::hardware_concurrency()), 1, 8);
+
+  for (int i = 1; i < argc; ++i) {
+    const char* value = nullptr;
+    string arg = argv[i];
+    if (arg == "-h" || arg == "--help") {
+      Usage(argv[0]);
+      std::exit(0);
+    } else if (arg == "-e" || arg == "--events") {
+      options.events = true;
+    } else if (arg == "--uring") {
+      options.uring = true;
+    } else if (Match(i, argc, argv, "-j", "--threads", value)) {
+      options.threads = Number(value, argv[0]);
+    } else if (Match(i, argc, argv, "-b", "--budget", value)) {
+      options.budget = Fraction(value, argv[0]);
+    } else if (Match(i, argc, argv, "-i", "--interval", value)) {
+      options.interval = Number(value, argv[0]);
+    } else if (Match(i, argc, argv, "-r", "--redraw", value)) {
+      options.redraw = Number(value, argv[0]);
+    } else if (Match(i, argc, argv, "-s", "--sort", value)) {
+      if (!Ranking::ParseKey(value, options.sort)) { Fail(argv[0]); }
+    } else if (Match(i, argc, argv, "-o", "--output", value)) {
+      options.headless = true;
+      if (!StreamWriter::ParseFormat(value, options.format)) { Fail(argv[0]); }
+    } else if (Match(i, argc, argv, "-f", "--file", value)) {
+      options.file = value;
+    } else if (Match(i, argc, argv, "-n", "--count", value)) {
+      options.count = Number(value, argv[0]);
+    } else if (Match(i, argc, argv, "", "--pss", value)) {
+      options.pss = Number(value, argv[0]);
+    } else if (Match(i, argc, argv, "", "--fds", value)) {
+      options.fds = Count(value, argv[0]);
+    } else if (Match(i, argc, argv, "", "--tasks", value)) {
+      options.tasks = Number(value, argv[0]);
+    } else if (Match(i, argc, argv, "", "--proc", value)) {
+      options.proc = value;
+    } else if (Match(i, argc, argv, "", "--history", value)) {
+      options.history = value;
+    } else if (Match(i, argc, argv, "", "--history-size", value)) {
+      options.history_size = Number(value, argv[0]);
+    } else if (Match(i, argc, argv, "", "--replay", value)) {
+      options.replay = value;
+    } else if (Match(i, argc, argv, "", "--at", value)) {
+      options.replay_at = TimeOfDay(value, argv[0]);
+    } else {
+      Fail(argv[0]);
+    }
+  }
+  return options;
+}
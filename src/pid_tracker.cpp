@@ -0,0 +1,143 @@
+#include <linux/cn_proc.h>
+#include <linux/connector.h>
+#include <linux/netlink.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include "linux_parser.h"
+#include "pid_tracker.h"
+
+using std::vector;
+
+// /proc is listed again every this many updates, a safety net for missed events
+static const unsigned long kResync{60};
+// how long to wait for the kernel to acknowledge the subscription
+static const int kAckTimeout{200};  // milliseconds
+// events of a whole interval queue up in the socket between two updates
+static const int kReceiveBuffer{4 << 20};
+
+PidTracker::PidTracker(bool events) : buffer_(16 * 1024) {
+  if (events && !Subscribe() && socket_ >= 0) {
+    close(socket_);
+    socket_ = -1;
+  }
+}
+
+PidTracker::~PidTracker() {
+  if (socket_ >= 0) { close(socket_); }
+}
+
+// Join the proc connector multicast group and ask it to start sending events
+// the kernel answers with a PROC_EVENT_NONE carrying the error code
+bool PidTracker::Subscribe() {
+  socket_ = socket(PF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK, NETLINK_CONNECTOR);
+  if (socket_ < 0) { return false; }
+  if (setsockopt(socket_, SOL_SOCKET, SO_RCVBUFFORCE, &kReceiveBuffer, sizeof(kReceiveBuffer)) != 0) {
+    setsockopt(socket_, SOL_SOCKET, SO_RCVBUF, &kReceiveBuffer, sizeof(kReceiveBuffer));
+  }
+  sockaddr_nl address{};
+  address.nl_family = AF_NETLINK;
+  address.nl_groups = CN_IDX_PROC;
+  if (bind(socket_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) { return false; }
+
+  alignas(nlmsghdr) char request[NLMSG_SPACE(sizeof(cn_msg) + sizeof(proc_cn_mcast_op))] = {};
+  nlmsghdr* header = reinterpret_cast<nlmsghdr*>(request);
+  header->nlmsg_len = NLMSG_LENGTH(sizeof(cn_msg) + sizeof(proc_cn_mcast_op));
+  header->nlmsg_type = NLMSG_DONE;
+  cn_msg* message = static_cast<cn_msg*>(NLMSG_DATA(header));
+  message->id.idx = CN_IDX_PROC;
+  message->id.val = CN_VAL_PROC;
+  message->len = sizeof(proc_cn_mcast_op);
+  proc_cn_mcast_op op = PROC_CN_MCAST_LISTEN;
+  std::memcpy(message->data, &op, sizeof(op));
+  if (send(socket_, request, header->nlmsg_len, 0) < 0) { return false; }
+
+  pollfd ready{socket_, POLLIN, 0};
+  while (poll(&ready, 1, kAckTimeout) > 0) {
+    ssize_t length = recv(socket_, buffer_.data(), buffer_.size(), 0);
+    if (length <= 0) { return false; }
+    for (nlmsghdr* reply = reinterpret_cast<nlmsghdr*>(buffer_.data()); NLMSG_OK(reply, length);
+         reply = NLMSG_NEXT(reply, length)) {
+      proc_event const* event =
+          reinterpret_cast<proc_event const*>(static_cast<cn_msg*>(NLMSG_DATA(reply))->data);
+      if (event->what == proc_event::PROC_EVENT_NONE) { return event->event_data.ack.err == 0; }
+    }
+  }
+  return false;
+}
+
+// Only whole processes are tracked, forks and exits of threads are skipped
+// an exited pid stays listed until the update reported it, unless it is
+// reused by a new process before
+bool PidTracker::Drain(vector<int>& exec, vector<int>& forked) {
+  while (true) {
+    ssize_t length = recv(socket_, buffer_.data(), buffer_.size(), 0);
+    if (length < 0) { return errno == EAGAIN || errno == EINTR; }
+    for (nlmsghdr* message = reinterpret_cast<nlmsghdr*>(buffer_.data()); NLMSG_OK(message, length);
+         message = NLMSG_NEXT(message, length)) {
+      if (message->nlmsg_type == NLMSG_ERROR || message->nlmsg_type == NLMSG_OVERRUN) { return false; }
+      proc_event const* event =
+          reinterpret_cast<proc_event const*>(static_cast<cn_msg*>(NLMSG_DATA(message))->data);
+      switch (event->what) {
+        case proc_event::PROC_EVENT_FORK:
+          if (event->event_data.fork.child_pid == event->event_data.fork.child_tgid) {
+            pids_.insert(event->event_data.fork.child_tgid);
+            exited_.erase(event->event_data.fork.child_tgid);
+            forked.push_back(event->event_data.fork.child_tgid);
+          }
+          break;
+        case proc_event::PROC_EVENT_EXEC:
+          pids_.insert(event->event_data.exec.process_tgid);
+          exec.push_back(event->event_data.exec.process_tgid);
+          break;
+        case proc_event::PROC_EVENT_EXIT:
+          if (event->event_data.exit.process_pid == event->event_data.exit.process_tgid) {
+            pids_.insert(event->event_data.exit.process_tgid);
+            exited_.insert(event->event_data.exit.process_tgid);
+          }
+          break;
+        default:
+          break;
+      }
+    }
+  }
+}
+
+// The queued events are applied first, a listing of /proc replaces their
+// result and the events arriving meanwhile are applied on the next update
+void PidTracker::Update(vector<int>& pids, vector<int>& exec, vector<int>& forked) {
+  exec.clear();
+  forked.clear();
+  if (socket_ < 0) {
+    pids = LinuxParser::Pids();
+    return;
+  }
+  bool lost = !Drain(exec, forked);
+  if (lost || scan_ || ++updates_ % kResync == 0) {
+    vector<int> listed = LinuxParser::Pids();
+    pids_.clear();
+    pids_.insert(listed.begin(), listed.end());
+    pids_.insert(exited_.begin(), exited_.end());
+    scan_ = false;
+  }
+  // ascending like the listing, new processes get appended in pid order
+  pids.assign(pids_.begin(), pids_.end());
+  std::sort(pids.begin(), pids.end());
+  // the exited ones were reported once, the next update drops them once
+  // the kernel no longer knows the pid: the exit event of a thread group
+  // leader also comes when it called pthread_exit and its other threads
+  // keep the process running, and an unreaped zombie still exists as well
+  for (auto pid = exited_.begin(); pid != exited_.end();) {
+    if (kill(*pid, 0) != 0 && errno == ESRCH) {
+      pids_.erase(*pid);
+      pid = exited_.erase(pid);
+    } else {
+      ++pid;
+    }
+  }
+}
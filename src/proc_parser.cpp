@@ -0,0 +1,151 @@
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+#include "proc_parser.h"
+
+using std::string_view;
+
+ProcParser::Path::Path(string_view directory, string_view file) {
+  Append(directory);
+  Append(file);
+}
+
+ProcParser::Path::Path(string_view directory, int pid, string_view file) {
+  Append(directory);
+  char digits[16];
+  auto result = std::to_chars(digits, digits + sizeof(digits), pid);
+  Append(string_view(digits, result.ptr - digits));
+  Append(file);
+}
+
+ProcParser::Path::Path(string_view directory, int pid, int tid, string_view file) {
+  Append(directory);
+  char digits[16];
+  auto result = std::to_chars(digits, digits + sizeof(digits), pid);
+  Append(string_view(digits, result.ptr - digits));
+  Append("/task/");
+  result = std::to_chars(digits, digits + sizeof(digits), tid);
+  Append(string_view(digits, result.ptr - digits));
+  Append(file);
+}
+
+void ProcParser::Path::Append(string_view part) {
+  if (size_ + part.size() >= sizeof(data_)) {
+    valid_ = false;
+    part = part.substr(0, sizeof(data_) - 1 - size_);
+  }
+  std::memcpy(data_ + size_, part.data(), part.size());
+  size_ += part.size();
+  data_[size_] = '\0';
+}
+
+// Read the whole file, proc files report size 0 so read until EOF
+bool ProcParser::ReadFile(int fd, Buffer& buffer) {
+  std::size_t size = 0;
+  while (true) {
+    if (size == buffer.Capacity()) { buffer.Grow(); }
+    ssize_t n = pread(fd, buffer.Data() + size, buffer.Capacity() - size, size);
+    if (n < 0) {
+      if (errno == EINTR) { continue; }
+      buffer.Resize(0);
+      return false;
+    }
+    if (n == 0) { break; }
+    size += n;
+  }
+  buffer.Resize(size);
+  return true;
+}
+
+bool ProcParser::ReadFile(const char* path, Buffer& buffer) {
+  int fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    buffer.Resize(0);
+    return false;
+  }
+  bool ok = ReadFile(fd, buffer);
+  close(fd);
+  return ok;
+}
+
+void ProcParser::Scanner::SkipBlanks() {
+  while (pos_ < end_ && (*pos_ == ' ' || *pos_ == '\t')) { ++pos_; }
+}
+
+void ProcParser::Scanner::SkipLine() {
+  const void* newline = std::memchr(pos_, '\n', end_ - pos_);
+  pos_ = newline ? static_cast<const char*>(newline) + 1 : end_;
+}
+
+void ProcParser::Scanner::SkipFields(int n) {
+  for (int i = 0; i < n; ++i) { Field(); }
+}
+
+string_view ProcParser::Scanner::Field() {
+  SkipBlanks();
+  const char* start = pos_;
+  while (pos_ < end_ && *pos_ != ' ' && *pos_ != '\t' && *pos_ != '\n') {
+    ++pos_;
+  }
+  return string_view(start, pos_ - start);
+}
+
+// Parse /proc/<pid>/stat
+// field 2 is the command in parens and may itself contain ") ", so
+// continue after the last closing paren
+bool ProcParser::ParsePidStat(string_view text, PidStat& stat) {
+  std::size_t paren = text.rfind(')');
+  if (paren == string_view::npos) { return false; }
+  Scanner scanner(text.substr(paren + 1));
+
+  string_view state = scanner.Field();
+  if (state.empty()) { return false; }
+  stat.state = state[0];
+  // fields 4 - 13: ppid pgrp session tty_nr tpgid flags minflt cminflt majflt cmajflt
+  if (!scanner.Number(stat.ppid)) { return false; }
+  scanner.SkipFields(9);
+  // fields 14 - 17: utime stime cutime cstime
+  if (!scanner.Number(stat.utime) || !scanner.Number(stat.stime) ||
+      !scanner.Number(stat.cutime) || !scanner.Number(stat.cstime)) {
+    return false;
+  }
+  // fields 18 - 19: priority nice
+  scanner.SkipFields(2);
+  if (!scanner.Number(stat.num_threads)) { return false; }
+  // field 21: itrealvalue
+  scanner.SkipFields(1);
+  if (!scanner.Number(stat.start_time) || !scanner.Number(stat.vsize) ||
+      !scanner.Number(stat.rss)) {
+    return false;
+  }
+  return true;
+}
+
+// Parse /proc/<pid>/io in one pass, "key: value" per line in kernel order
+// cancelled_write_bytes is not used
+bool ProcParser::ParsePidIo(string_view text, PidIo& io) {
+  int found = 0;
+  Scanner scanner(text);
+  while (!scanner.Done()) {
+    string_view key = scanner.Field();
+    unsigned long long* value = nullptr;
+    if (key == "rchar:") {
+      value = &io.rchar;
+    } else if (key == "wchar:") {
+      value = &io.wchar;
+    } else if (key == "syscr:") {
+      value = &io.syscr;
+    } else if (key == "syscw:") {
+      value = &io.syscw;
+    } else if (key == "read_bytes:") {
+      value = &io.read_bytes;
+    } else if (key == "write_bytes:") {
+      value = &io.write_bytes;
+    }
+    if (value != nullptr && scanner.Number(*value)) { ++found; }
+    scanner.SkipLine();
+  }
+  return found == 6;
+}
@@ -0,0 +1,49 @@
+#include <regex>
+
+#include "process_filter.h"
+
+using std::size_t;
+using std::vector;
+
+bool ProcessFilter::Set(std::string const& pattern) {
+  if (pattern == pattern_) { return true; }
+  if (!pattern.empty()) {
+    try {
+      regex_.assign(pattern, std::regex::ECMAScript | std::regex::icase | std::regex::optimize);
+    } catch (std::regex_error const&) {
+      return false;
+    }
+  }
+  pattern_ = pattern;
+  matches_.clear();
+  searches_ = 0;
+  return true;
+}
+
+bool ProcessFilter::Matches(ProcessTable const& processes, StringArena::Id id) {
+  if (id >= matches_.size()) { matches_.resize(id + 1, -1); }
+  if (matches_[id] < 0) {
+    std::string_view text = processes.String(id);
+    matches_[id] = std::regex_search(text.begin(), text.end(), regex_);
+    ++searches_;
+  }
+  return matches_[id] == 1;
+}
+
+// Ids are handed out anew in another generation, its cache starts over
+void ProcessFilter::Apply(ProcessTable const& processes, vector<size_t> const& order, vector<size_t>& rows) {
+  if (pattern_.empty()) {
+    rows = order;
+    return;
+  }
+  if (processes.Generation() != generation_) {
+    generation_ = processes.Generation();
+    matches_.clear();
+  }
+  rows.clear();
+  for (size_t row : order) {
+    if (Matches(processes, processes.UserId(row)) || Matches(processes, processes.CommandId(row))) {
+      rows.push_back(row);
+    }
+  }
+}
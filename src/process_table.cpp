@@ -0,0 +1,268 @@
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <limits>
+
+#include "process_table.h"
+
+using std::size_t;
+using std::string_view;
+using std::vector;
+
+// The arena is rebuilt once it holds this many bytes more than twice the live strings
+static const size_t kGarbage{64 * 1024};
+
+StringArena::Id StringArena::Add(string_view text) {
+  spans_.push_back({std::uint32_t(data_.size()), std::uint32_t(text.size())});
+  data_.append(text);
+  return Id(spans_.size() - 1);
+}
+
+void StringArena::Clear() {
+  data_.clear();
+  spans_.clear();
+}
+
+// Equal strings share one id, user names and commands repeat a lot
+StringArena::Id ProcessTable::Intern(string_view text) {
+  auto found = index_.try_emplace(std::string(text), StringArena::Id(strings_.Size()));
+  if (found.second) { strings_.Add(text); }
+  return found.first->second;
+}
+
+size_t ProcessTable::Add(int p, int u, string_view user, string_view command, string_view cgroup) {
+  pid.push_back(p);
+  uid.push_back(u);
+  start_time.push_back(0);
+  utime.push_back(0);
+  stime.push_back(0);
+  rss_kb.push_back(0);
+  uptime.push_back(0);
+  cpu.push_back(0.0f);
+  cpu_time.emplace_back();
+  pss_kb.push_back(-1);
+  uss_kb.push_back(-1);
+  smaps_tick.push_back(0);
+  read_rate.push_back(-1.0f);
+  write_rate.push_back(-1.0f);
+  syscall_rate.push_back(-1.0f);
+  io_counters.emplace_back();
+  user_.push_back(Intern(user));
+  command_.push_back(Intern(command));
+  cgroup_.push_back(Intern(cgroup));
+  return pid.size() - 1;
+}
+
+float ProcessTable::Hertz() {
+  static const float hertz = sysconf(_SC_CLK_TCK);
+  return hertz;
+}
+
+long ProcessTable::PageKb() {
+  static const long page_kb = sysconf(_SC_PAGESIZE) / 1024;
+  return page_kb;
+}
+
+void ProcessTable::Store(size_t row, ProcParser::PidStat const& stat, long rss, double time) {
+  float hertz = Hertz();
+  unsigned long long jiffies = stat.utime + stat.stime;
+  float seconds = time - (stat.start_time / hertz);
+
+  start_time[row] = stat.start_time;
+  utime[row] = stat.utime;
+  stime[row] = stat.stime;
+  rss_kb[row] = rss;
+  uptime[row] = seconds;
+
+  double rate;
+  if (cpu_time[row].Update(jiffies, time, rate)) {
+    cpu[row] = rate / hertz;
+  } else {
+    cpu[row] = seconds > 0 ? (jiffies / hertz) / seconds : 0.0f;
+  }
+}
+
+// Rate of one counter, the lifetime average of a process seen for the first time
+static float Rate(DeltaCounter& counter, unsigned long long value, double time, long age) {
+  double rate;
+  if (counter.Update(value, time, rate)) { return rate; }
+  return age > 0 ? float(value) / age : 0.0f;
+}
+
+void ProcessTable::StoreIo(size_t row, ProcParser::PidIo const& io, double time) {
+  IoCounters& counters = io_counters[row];
+  read_rate[row] = Rate(counters.read, io.read_bytes, time, uptime[row]);
+  write_rate[row] = Rate(counters.write, io.write_bytes, time, uptime[row]);
+  syscall_rate[row] = Rate(counters.syscalls, io.syscr + io.syscw, time, uptime[row]);
+}
+
+unsigned long ProcessTable::NextGeneration() {
+  static std::atomic<unsigned long> generations{0};
+  return generations.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+// Sort the rows appended to an order and merge them into the sorted front
+template <typename Before>
+static void Merge(vector<size_t>& order, size_t rows, Before before) {
+  size_t sorted = order.size();
+  for (size_t row = sorted; row < rows; ++row) { order.push_back(row); }
+  std::sort(order.begin() + sorted, order.end(), before);
+  std::inplace_merge(order.begin(), order.begin() + sorted, order.end(), before);
+}
+
+// The orders hold the rows before the first one added since, so only those
+// are sorted; a tick adds few rows to a large table
+void ProcessTable::Index() {
+  if (by_pid_.size() == Size()) { return; }
+  Merge(by_pid_, Size(), [this](size_t a, size_t b) { return pid[a] < pid[b]; });
+  // equal ids are equal names, which saves most string compares
+  Merge(by_user_, Size(), [this](size_t a, size_t b) {
+    if (user_[a] != user_[b]) {
+      int order = User(a).compare(User(b));
+      if (order != 0) { return order < 0; }
+    }
+    return pid[a] < pid[b];
+  });
+}
+
+// The indexed rows by binary search, the ones added since by a scan
+size_t ProcessTable::Find(int p) const {
+  auto found = std::lower_bound(by_pid_.begin(), by_pid_.end(), p,
+                                [this](size_t row, int value) { return pid[row] < value; });
+  if (found != by_pid_.end() && pid[*found] == p) { return *found; }
+  for (size_t row = by_pid_.size(); row < Size(); ++row) {
+    if (pid[row] == p) { return row; }
+  }
+  return Size();
+}
+
+// Drop the rows of an order that are not kept and renumber the others
+static void Filter(vector<size_t>& order, vector<size_t> const& moved, vector<char> const& keep) {
+  size_t kept = 0;
+  for (size_t row : order) {
+    if (keep[row]) { order[kept++] = moved[row]; }
+  }
+  order.resize(kept);
+}
+
+// Move the kept entries of a column to the front
+template <typename T>
+static void Filter(vector<T>& column, vector<char> const& keep) {
+  size_t kept = 0;
+  for (size_t i = 0; i < column.size(); ++i) {
+    if (!keep[i]) { continue; }
+    if (kept != i) { column[kept] = column[i]; }
+    ++kept;
+  }
+  column.resize(kept);
+}
+
+void ProcessTable::Keep(vector<char> const& keep) {
+  // new index of every kept row, for the orders
+  vector<size_t> moved(Size());
+  size_t kept = 0;
+  for (size_t row = 0; row < Size(); ++row) { moved[row] = keep[row] ? kept++ : kept; }
+  Filter(by_pid_, moved, keep);
+  Filter(by_user_, moved, keep);
+
+  Filter(pid, keep);
+  Filter(uid, keep);
+  Filter(start_time, keep);
+  Filter(utime, keep);
+  Filter(stime, keep);
+  Filter(rss_kb, keep);
+  Filter(uptime, keep);
+  Filter(cpu, keep);
+  Filter(cpu_time, keep);
+  Filter(pss_kb, keep);
+  Filter(uss_kb, keep);
+  Filter(smaps_tick, keep);
+  Filter(read_rate, keep);
+  Filter(write_rate, keep);
+  Filter(syscall_rate, keep);
+  Filter(io_counters, keep);
+  Filter(user_, keep);
+  Filter(command_, keep);
+  Filter(cgroup_, keep);
+
+  // an upper bound, shared strings are counted once per row
+  size_t live = 0;
+  for (size_t row = 0; row < Size(); ++row) {
+    live += User(row).size() + Command(row).size() + Cgroup(row).size();
+  }
+  if (strings_.Bytes() > 2 * live + kGarbage) { Compact(); }
+}
+
+void ProcessTable::Compact() {
+  const StringArena::Id none = std::numeric_limits<StringArena::Id>::max();
+  vector<StringArena::Id> moved(strings_.Size(), none);
+  StringArena strings;
+  index_.clear();
+  auto move = [&](StringArena::Id& id) {
+    if (moved[id] == none) {
+      moved[id] = strings.Add(strings_.Get(id));
+      index_.emplace(std::string(strings_.Get(id)), moved[id]);
+    }
+    id = moved[id];
+  };
+  for (StringArena::Id& id : user_) { move(id); }
+  for (StringArena::Id& id : command_) { move(id); }
+  for (StringArena::Id& id : cgroup_) { move(id); }
+  strings_ = std::move(strings);
+  generation_ = NextGeneration();
+}
+
+void ProcessTable::Clear() {
+  pid.clear();
+  uid.clear();
+  start_time.clear();
+  utime.clear();
+  stime.clear();
+  rss_kb.clear();
+  uptime.clear();
+  cpu.clear();
+  cpu_time.clear();
+  pss_kb.clear();
+  uss_kb.clear();
+  smaps_tick.clear();
+  read_rate.clear();
+  write_rate.clear();
+  syscall_rate.clear();
+  io_counters.clear();
+  user_.clear();
+  command_.clear();
+  cgroup_.clear();
+  strings_.Clear();
+  index_.clear();
+  by_pid_.clear();
+  by_user_.clear();
+  generation_ = NextGeneration();
+}
+
+void ProcessTable::Assign(ProcessTable const& other) {
+  pid = other.pid;
+  uid = other.uid;
+  start_time = other.start_time;
+  utime = other.utime;
+  stime = other.stime;
+  rss_kb = other.rss_kb;
+  uptime = other.uptime;
+  cpu = other.cpu;
+  cpu_time = other.cpu_time;
+  pss_kb = other.pss_kb;
+  uss_kb = other.uss_kb;
+  smaps_tick = other.smaps_tick;
+  read_rate = other.read_rate;
+  write_rate = other.write_rate;
+  syscall_rate = other.syscall_rate;
+  io_counters = other.io_counters;
+  user_ = other.user_;
+  command_ = other.command_;
+  cgroup_ = other.cgroup_;
+  strings_ = other.strings_;
+  index_.clear();
+  generation_ = other.generation_;
+  by_pid_ = other.by_pid_;
+  by_user_ = other.by_user_;
+  Index();
+}
@@ -1,45 +1,121 @@
+#include <algorithm>
 #include <vector>
-#include <string>
-#include <chrono>
-#include <thread>
 
-#include "processor.h"
 #include "linux_parser.h"
+#include "processor.h"
 
-using namespace std;
-
-// Return the aggregate CPU utilization
-float Processor::Utilization() { 
-    float previdle{0.0f}, idle{0.0f}, prevnonidle{0.0f}, nonidle{0.0f};
-    vector<string> time1 = LinuxParser::CpuUtilization();
-    this_thread::sleep_for(chrono::milliseconds(30));
-    vector<string> time2 = LinuxParser::CpuUtilization();
-
-    //Idle = idle + iowait
-    if (LinuxParser::is_number(time1[3]) && LinuxParser::is_number(time1[4]) && LinuxParser::is_number(time2[3]) && LinuxParser::is_number(time1[4])) {
-      previdle = stof(time1[3]) + stof(time1[4]);
-      idle = stof(time2[3]) + stof(time2[4]);
-    }
+using std::int32_t;
+using std::int64_t;
+using std::vector;
 
-    //nonidle = user + nice + system + irq + softirq + steal
-    if (LinuxParser::is_number(time1[0]) && LinuxParser::is_number(time1[1]) && LinuxParser::is_number(time1[2]) && LinuxParser::is_number(time1[5]) && LinuxParser::is_number(time1[7])) {
-       prevnonidle = stof(time1[0]) + stof(time1[1]) + stof(time1[2]) + stof(time1[5]) + stof(time1[6]) + stof(time1[7]);
-    }
-    
-    if (LinuxParser::is_number(time2[0]) && LinuxParser::is_number(time2[1]) && LinuxParser::is_number(time2[2]) && LinuxParser::is_number(time2[5]) && LinuxParser::is_number(time2[7])) {
-      nonidle = stof(time2[0]) + stof(time2[1]) + stof(time2[2]) + stof(time2[5]) + stof(time2[6]) + stof(time2[7]);
-    }
-    //total = idle + nonidle
-    float prevtotal = previdle + prevnonidle;
-    float total = idle + nonidle;
+Processor::Processor() : cpu_nodes_(LinuxParser::CpuNodes()) {}
 
+// Share of non idle time between two samples
+float Processor::Utilization(CpuTimes const& previous, CpuTimes const& current) {
     //differentiate 
+    unsigned long long total = current.Total();
+    unsigned long long prevtotal = previous.Total();
+    if (total <= prevtotal) { return 0.0f; }
+
     float totald = total - prevtotal;
-    float idled = idle - previdle;
+    float idled = current.Idle() >= previous.Idle() ? current.Idle() - previous.Idle() : 0;
 
     return ((totald - idled) / totald);
+}
 
+// Compute the utilization since the last snapshot and keep this one for the next call
+// the first call yields the average since boot
+void Processor::Update(SystemSnapshot const& snapshot) {
+    utilization_ = Utilization(previous_, snapshot.Cpu());
+    previous_ = snapshot.Cpu();
 
+    CpuMatrix const& cores = snapshot.Cores();
+    std::size_t count = cores.Cores();
+    // cores going on- or offline change the cpuN lines, start over from boot
+    bool reset = cores.Ids() != ids_;
+    if (reset) {
+      ids_ = cores.Ids();
+      previous_idle_.assign(count, 0);
+      previous_total_.assign(count, 0);
+      core_nodes_.resize(count);
+      int nodes{1};
+      for (std::size_t i = 0; i < count; ++i) {
+        int id = ids_[i];
+        core_nodes_[i] = id < int(cpu_nodes_.size()) && cpu_nodes_[id] >= 0 ? cpu_nodes_[id] : 0;
+        nodes = std::max(nodes, core_nodes_[i] + 1);
+      }
+      node_utilization_.assign(nodes, 0.0f);
+    }
+    busy_delta_.resize(count);
+    total_delta_.resize(count);
+    core_utilization_.resize(count);
+    std::uint64_t const* column[CpuMatrix::kFields];
+    for (std::size_t field = 0; field < CpuMatrix::kFields; ++field) { column[field] = cores.Column(field); }
+    std::uint32_t* previous_idle = previous_idle_.data();
+    std::uint32_t* previous_total = previous_total_.data();
+    int32_t* busy_delta = busy_delta_.data();
+    int32_t* total_delta = total_delta_.data();
+    float* utilization = core_utilization_.data();
+    if (reset) {
+      // the first interval is the time since boot, scaled down to fit 32 bits
+      for (std::size_t i = 0; i < count; ++i) {
+        std::uint64_t total{0};
+        for (std::size_t field = 0; field < CpuMatrix::kFields; ++field) { total += column[field][i]; }
+        std::uint64_t idle = column[CpuMatrix::kIdle][i] + column[CpuMatrix::kIowait][i];
+        int shift = total > INT32_MAX ? 16 : 0;
+        total_delta[i] = int32_t(total >> shift);
+        busy_delta[i] = int32_t((total - std::min(idle, total)) >> shift);
+        previous_idle[i] = std::uint32_t(idle);
+        previous_total[i] = std::uint32_t(total);
+      }
+    } else {
+      // one pass over the columns, branch free in 32 bit lanes so it
+      // vectorizes on any x86-64: an interval is far below 2^31 jiffies,
+      // so the low halves of the sums are enough for the deltas
+      std::uint64_t const *user = column[0], *nice = column[1], *system = column[2], *idle_time = column[3],
+                          *iowait = column[4], *irq = column[5], *softirq = column[6], *steal = column[7];
+      for (std::size_t i = 0; i < count; ++i) {
+        std::uint32_t idle = std::uint32_t(idle_time[i]) + std::uint32_t(iowait[i]);
+        std::uint32_t total = idle + std::uint32_t(user[i]) + std::uint32_t(nice[i]) + std::uint32_t(system[i]) +
+                              std::uint32_t(irq[i]) + std::uint32_t(softirq[i]) + std::uint32_t(steal[i]);
+        int32_t total_jiffies = int32_t(total - previous_total[i]);
+        total_jiffies = total_jiffies > 0 ? total_jiffies : 0;
+        int32_t idle_jiffies = int32_t(idle - previous_idle[i]);
+        idle_jiffies = idle_jiffies > 0 ? idle_jiffies : 0;
+        idle_jiffies = idle_jiffies < total_jiffies ? idle_jiffies : total_jiffies;
+        previous_idle[i] = idle;
+        previous_total[i] = total;
+        total_delta[i] = total_jiffies;
+        busy_delta[i] = total_jiffies - idle_jiffies;
+      }
+    }
+    for (std::size_t i = 0; i < count; ++i) {
+      int32_t jiffies = total_delta[i] > 1 ? total_delta[i] : 1;
+      utilization[i] = float(busy_delta[i]) / float(jiffies);
+    }
+
+    // a node is as busy as all of its cores together, one masked pass per
+    // node keeps the sums in registers, there are only a few nodes
+    int const* core_nodes = core_nodes_.data();
+    for (std::size_t node = 0; node < node_utilization_.size(); ++node) {
+      int64_t busy{0}, jiffies{0};
+      for (std::size_t i = 0; i < count; ++i) {
+        bool member = core_nodes[i] == int(node);
+        busy += member ? busy_delta[i] : 0;
+        jiffies += member ? total_delta[i] : 0;
+      }
+      node_utilization_[node] = jiffies > 0 ? float(busy) / jiffies : 0.0f;
+    }
 }
-    
-  
\ No newline at end of file
+
+// Return the aggregate CPU utilization
+float Processor::Utilization() const { return utilization_; }
+
+// Return the utilization of every core
+vector<float> const& Processor::CoreUtilization() const { return core_utilization_; }
+
+// Return the NUMA node of every core, 0 without NUMA support
+vector<int> const& Processor::CoreNodes() const { return core_nodes_; }
+
+// Return the utilization of every NUMA node
+vector<float> const& Processor::NodeUtilization() const { return node_utilization_; }
@@ -0,0 +1,164 @@
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+
+#include "instrument.h"
+#include "ranking.h"
+
+using std::size_t;
+using std::vector;
+
+bool Ranking::ParseKey(std::string const& name, Key& key) {
+  if (name == "cpu") {
+    key = Key::kCpu;
+  } else if (name == "ram") {
+    key = Key::kRam;
+  } else if (name == "pid") {
+    key = Key::kPid;
+  } else if (name == "time") {
+    key = Key::kUpTime;
+  } else if (name == "user") {
+    key = Key::kUser;
+  } else if (name == "read") {
+    key = Key::kRead;
+  } else if (name == "write") {
+    key = Key::kWrite;
+  } else if (name == "syscalls") {
+    key = Key::kSyscalls;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+char const* Ranking::Name(Key key) {
+  switch (key) {
+    case Key::kCpu: return "cpu";
+    case Key::kRam: return "ram";
+    case Key::kPid: return "pid";
+    case Key::kUpTime: return "time";
+    case Key::kUser: return "user";
+    case Key::kRead: return "read";
+    case Key::kWrite: return "write";
+    case Key::kSyscalls: return "syscalls";
+    case Key::kCount: break;
+  }
+  return "";
+}
+
+using Entry = std::pair<float, std::uint32_t>;
+
+// Pair every value of a column with its row
+template <typename T>
+static void Keys(vector<T> const& column, vector<Entry>& entries) {
+  entries.resize(column.size());
+  for (size_t i = 0; i < column.size(); ++i) { entries[i] = {float(column[i]), std::uint32_t(i)}; }
+}
+
+// The same for some of the rows
+template <typename T>
+static void Keys(vector<T> const& column, vector<size_t> const& rows, vector<Entry>& entries) {
+  entries.resize(rows.size());
+  for (size_t i = 0; i < rows.size(); ++i) { entries[i] = {float(column[rows[i]]), std::uint32_t(rows[i])}; }
+}
+
+// The column of a key that is not indexed
+template <typename... Rows>
+static void Keys(ProcessTable const& processes, Ranking::Key key, vector<Entry>& entries, Rows const&... rows) {
+  switch (key) {
+    case Ranking::Key::kRam: Keys(processes.rss_kb, rows..., entries); break;
+    case Ranking::Key::kUpTime: Keys(processes.uptime, rows..., entries); break;
+    case Ranking::Key::kRead: Keys(processes.read_rate, rows..., entries); break;
+    case Ranking::Key::kWrite: Keys(processes.write_rate, rows..., entries); break;
+    case Ranking::Key::kSyscalls: Keys(processes.syscall_rate, rows..., entries); break;
+    default: Keys(processes.cpu, rows..., entries); break;
+  }
+}
+
+static bool Indexed(Ranking::Key key) { return key == Ranking::Key::kPid || key == Ranking::Key::kUser; }
+
+// Ties broken by index so the order is stable between frames
+static bool Larger(Entry const& a, Entry const& b) {
+  return a.first > b.first || (a.first == b.first && a.second < b.second);
+}
+
+// Select the n largest
+void Ranking::Top(ProcessTable const& processes, Key key, size_t n, vector<size_t>& top) {
+  Instrument::Span span(Instrument::Stage::kRank);
+  if (Indexed(key)) {
+    vector<size_t> const& order = Order(processes, key);
+    top.assign(order.begin(), order.begin() + std::min(n, order.size()));
+    return;
+  }
+  thread_local vector<Entry> entries;
+  Keys(processes, key, entries);
+  n = std::min(n, entries.size());
+  if (n < entries.size()) {
+    std::nth_element(entries.begin(), entries.begin() + n, entries.end(), Larger);
+  }
+  std::sort(entries.begin(), entries.begin() + n, Larger);
+
+  top.resize(n);
+  for (size_t i = 0; i < n; ++i) { top[i] = entries[i].second; }
+}
+
+vector<size_t> const& Ranking::Order(ProcessTable const& processes, Key key) {
+  return key == Key::kUser ? processes.ByUser() : processes.ByPid();
+}
+
+// Rows of an indexed key are already in order, a slice is the page; the
+// others select the page with two nth_elements, so only its rows are sorted
+// however deep it is
+void Ranking::Page(ProcessTable const& processes, Key key, vector<size_t> const& rows, size_t first, size_t n,
+                   vector<size_t>& page) {
+  Instrument::Span span(Instrument::Stage::kRank);
+  first = std::min(first, rows.size());
+  n = std::min(n, rows.size() - first);
+  if (Indexed(key)) {
+    page.assign(rows.begin() + first, rows.begin() + first + n);
+    return;
+  }
+  thread_local vector<Entry> entries;
+  Keys(processes, key, entries, rows);
+  auto begin = entries.begin() + first;
+  auto end = begin + n;
+  if (first > 0) { std::nth_element(entries.begin(), begin, entries.end(), Larger); }
+  if (end != entries.end()) { std::nth_element(begin, end, entries.end(), Larger); }
+  std::sort(begin, end, Larger);
+
+  page.resize(n);
+  for (size_t i = 0; i < n; ++i) { page[i] = begin[i].second; }
+}
+
+// The rows ahead of it are counted, nothing is sorted; pid order allows a
+// binary search
+size_t Ranking::Position(ProcessTable const& processes, Key key, vector<size_t> const& rows, size_t row) {
+  Instrument::Span span(Instrument::Stage::kRank);
+  if (key == Key::kPid) {
+    auto found = std::lower_bound(rows.begin(), rows.end(), processes.pid[row],
+                                  [&processes](size_t a, int pid) { return processes.pid[a] < pid; });
+    return found != rows.end() && *found == row ? found - rows.begin() : rows.size();
+  }
+  size_t index = std::find(rows.begin(), rows.end(), row) - rows.begin();
+  if (key == Key::kUser || index == rows.size()) { return index; }
+  thread_local vector<Entry> entries;
+  Keys(processes, key, entries, rows);
+  Entry const self{entries[index]};
+  return std::count_if(entries.begin(), entries.end(), [&self](Entry const& entry) { return Larger(entry, self); });
+}
+
+// Pages start at multiples of n, so the pid keeps its page while it moves
+// within it
+Ranking::Cursor Ranking::Follow(ProcessTable const& processes, Key key, vector<size_t> const& rows, int pid,
+                                size_t n) {
+  Cursor cursor;
+  if (pid <= 0 || n == 0) { return cursor; }
+  size_t row = processes.Find(pid);
+  if (row == processes.Size()) { return cursor; }
+  size_t position = Position(processes, key, rows, row);
+  if (position == rows.size()) { return cursor; }
+  cursor.first = position - position % n;
+  cursor.selected = row;
+  cursor.found = true;
+  return cursor;
+}
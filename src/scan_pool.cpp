@@ -0,0 +1,76 @@
+#include <algorithm>
+
+#include "scan_pool.h"
+
+ScanPool::ScanPool(int threads)
+    : size_(std::max(threads, 1)), shards_(new Shard[std::max(threads, 1)]) {
+  for (int worker = 1; worker < size_; ++worker) {
+    threads_.emplace_back(&ScanPool::Work, this, worker);
+  }
+}
+
+ScanPool::~ScanPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  start_.notify_all();
+  for (std::thread& thread : threads_) { thread.join(); }
+}
+
+void ScanPool::Run(std::size_t count, Task const& task) {
+  if (count == 0) { return; }
+  if (size_ == 1) {
+    task(0, count, 0);
+    return;
+  }
+
+  // contiguous shards keep neighbouring pids on one worker
+  std::size_t shard_size = (count + size_ - 1) / size_;
+  for (int i = 0; i < size_; ++i) {
+    shards_[i].next.store(std::min(count, i * shard_size), std::memory_order_relaxed);
+    shards_[i].end = std::min(count, (i + 1) * shard_size);
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    task_ = &task;
+    running_ = size_ - 1;
+    ++generation_;
+  }
+  start_.notify_all();
+
+  Drain(0);
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  done_.wait(lock, [this] { return running_ == 0; });
+  task_ = nullptr;
+}
+
+void ScanPool::Work(int worker) {
+  unsigned long seen = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      start_.wait(lock, [&] { return stop_ || generation_ != seen; });
+      if (stop_) { return; }
+      seen = generation_;
+    }
+    Drain(worker);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (--running_ == 0) { done_.notify_one(); }
+    }
+  }
+}
+
+// Own shard first, then walk the other shards and steal what is left
+void ScanPool::Drain(int worker) {
+  for (int i = 0; i < size_; ++i) {
+    Shard& shard = shards_[(worker + i) % size_];
+    while (true) {
+      std::size_t begin = shard.next.fetch_add(kChunk, std::memory_order_relaxed);
+      if (begin >= shard.end) { break; }
+      (*task_)(begin, std::min(begin + kChunk, shard.end), worker);
+    }
+  }
+}
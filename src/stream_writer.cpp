@@ -0,0 +1,302 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+
+#include "instrument.h"
+#include "stream_writer.h"
+
+using std::string_view;
+
+bool StreamWriter::ParseFormat(std::string const& name, Format& format) {
+  if (name == "json") {
+    format = Format::kJson;
+  } else if (name == "csv") {
+    format = Format::kCsv;
+  } else if (name == "binary") {
+    format = Format::kBinary;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+void StreamWriter::Write(Sample const& sample) {
+  Instrument::Span span(Instrument::Stage::kOutput);
+  switch (format_) {
+    case Format::kJson: WriteJson(sample); break;
+    case Format::kCsv: WriteCsv(sample); break;
+    case Format::kBinary: WriteBinary(sample); break;
+  }
+  std::fflush(out_);
+}
+
+// Keep the cadence of the interval, the first sample is written right away
+void StreamWriter::Stream(Producer const& producer, std::chrono::milliseconds interval, long count) {
+  Sample sample;
+  auto next = std::chrono::steady_clock::now();
+  for (long written = 0; count == 0 || written < count; ++written) {
+    if (written > 0) { std::this_thread::sleep_until(next); }
+    producer(sample);
+    sample.sequence = written + 1;
+    Write(sample);
+    if (std::ferror(out_)) { return; }
+    next = std::max(next + interval * sample.backoff, std::chrono::steady_clock::now());
+  }
+}
+
+// Quoted and escaped JSON string
+void StreamWriter::JsonString(string_view text) {
+  std::fputc('"', out_);
+  for (char c : text) {
+    unsigned char u = c;
+    if (c == '"' || c == '\\') {
+      std::fputc('\\', out_);
+      std::fputc(c, out_);
+    } else if (u < 0x20) {
+      std::fprintf(out_, "\\u%04x", u);
+    } else {
+      std::fputc(c, out_);
+    }
+  }
+  std::fputc('"', out_);
+}
+
+void StreamWriter::WriteJson(Sample const& sample) {
+  std::fprintf(out_, "{\"sequence\":%lu,\"time\":%lld,\"os\":", sample.sequence, sample.time);
+  JsonString(sample.os);
+  std::fputs(",\"kernel\":", out_);
+  JsonString(sample.kernel);
+  std::fprintf(out_, ",\"cpu\":%.4f,\"cores\":[", sample.cpu);
+  for (std::size_t i = 0; i < sample.cores.size(); ++i) {
+    std::fprintf(out_, i ? ",%.4f" : "%.4f", sample.cores[i]);
+  }
+  std::fputs("],\"nodes\":[", out_);
+  for (std::size_t i = 0; i < sample.nodes.size(); ++i) {
+    std::fprintf(out_, i ? ",%.4f" : "%.4f", sample.nodes[i]);
+  }
+  std::fputs("],\"core_nodes\":[", out_);
+  for (std::size_t i = 0; i < sample.core_nodes.size(); ++i) {
+    std::fprintf(out_, i ? ",%d" : "%d", sample.core_nodes[i]);
+  }
+  MemInfo const& memory = sample.meminfo;
+  std::fprintf(out_, "],\"memory\":%.4f,\"swap\":%.4f,\"memory_kb\":{\"total\":%llu,\"free\":%llu,"
+               "\"available\":%llu,\"buffers\":%llu,\"cached\":%llu,\"shmem\":%llu,\"slab_reclaimable\":%llu,"
+               "\"slab_unreclaimable\":%llu,\"swap_total\":%llu,\"swap_free\":%llu}",
+               sample.memory, sample.swap, memory.total, memory.free, memory.available, memory.buffers,
+               memory.cached, memory.shmem, memory.slab_reclaimable, memory.slab_unreclaimable,
+               memory.swap_total, memory.swap_free);
+  IoRates const& io = sample.io;
+  std::fprintf(out_, ",\"io\":{\"disk_read\":%.0f,\"disk_write\":%.0f,\"net_receive\":%.0f,\"net_send\":%.0f}",
+               io.disk_read, io.disk_write, io.net_receive, io.net_send);
+  std::fprintf(out_, ",\"total_processes\":%d,\"running_processes\":%d,\"uptime\":%ld,\"processes\":[",
+               sample.total_processes, sample.running_processes, sample.uptime);
+  ProcessTable const& processes = sample.processes;
+  for (std::size_t i = 0; i < processes.Size(); ++i) {
+    std::fprintf(out_, "%s{\"pid\":%d,\"uid\":%d,\"user\":", i ? "," : "", processes.pid[i], processes.uid[i]);
+    JsonString(processes.User(i));
+    std::fprintf(out_, ",\"cpu\":%.4f,\"ram_kb\":%ld,\"pss_kb\":%ld,\"uss_kb\":%ld,\"read_bps\":%.0f,"
+                 "\"write_bps\":%.0f,\"syscalls_ps\":%.0f,\"uptime\":%ld,\"command\":",
+                 processes.cpu[i], processes.rss_kb[i], processes.pss_kb[i], processes.uss_kb[i],
+                 processes.read_rate[i], processes.write_rate[i], processes.syscall_rate[i], processes.uptime[i]);
+    JsonString(processes.Command(i));
+    std::fputc('}', out_);
+  }
+  std::fputs("],\"cgroups\":[", out_);
+  for (std::size_t i = 0; i < sample.cgroups.size(); ++i) {
+    CgroupUsage const& cgroup = sample.cgroups[i];
+    std::fputs(i ? ",{\"path\":" : "{\"path\":", out_);
+    JsonString(cgroup.path);
+    std::fprintf(out_, ",\"depth\":%d,\"processes\":%d,\"cpu\":%.4f,\"memory_kb\":%ld}",
+                 cgroup.depth, cgroup.processes, cgroup.cpu, cgroup.memory_kb);
+  }
+  std::fputs("],\"threads\":[", out_);
+  for (std::size_t i = 0; i < sample.threads.size(); ++i) {
+    ThreadUsage const& thread = sample.threads[i];
+    std::fprintf(out_, "%s{\"tid\":%d,\"pid\":%d,\"cpu\":%.4f,\"name\":", i ? "," : "", thread.tid, thread.pid,
+                 thread.cpu);
+    JsonString(thread.name);
+    std::fputc('}', out_);
+  }
+  std::fprintf(out_, "],\"self\":{\"cpu\":%.4f,\"cold_period\":%d,\"backoff\":%d},\"timings\":{",
+               sample.self_cpu, sample.cold_period, sample.backoff);
+  for (std::size_t i = 0; i < sample.timings.size(); ++i) {
+    Instrument::Summary const& timing = sample.timings[i];
+    std::fprintf(out_, "%s\"%s\":{\"count\":%llu,\"last_us\":%.1f,\"mean_us\":%.1f,\"p50_us\":%.1f,\"p99_us\":%.1f}",
+                 i ? "," : "", timing.name, timing.count, timing.last, timing.mean, timing.p50, timing.p99);
+  }
+  std::fputs("}}\n", out_);
+}
+
+// Quoted when needed, inner quotes doubled
+void StreamWriter::CsvString(string_view text) {
+  if (text.find_first_of(",\"\n\r") == string_view::npos) {
+    std::fwrite(text.data(), 1, text.size(), out_);
+    return;
+  }
+  std::fputc('"', out_);
+  for (char c : text) {
+    if (c == '"') { std::fputc('"', out_); }
+    std::fputc(c, out_);
+  }
+  std::fputc('"', out_);
+}
+
+void StreamWriter::WriteCsv(Sample const& sample) {
+  if (!header_) {
+    std::fputs("record,sequence,time,cpu,memory,total_processes,running_processes,uptime,self_cpu,cold_period,backoff,"
+               "swap,available_kb,cached_kb,slab_kb,swap_used_kb,disk_read_bps,disk_write_bps,net_receive_bps,"
+               "net_send_bps\n"
+               "record,sequence,time,pid,uid,user,cpu,ram_kb,pss_kb,uss_kb,read_bps,write_bps,syscalls_ps,uptime,"
+               "command\n"
+               "record,sequence,time,stage,count,last_us,mean_us,p50_us,p99_us\n"
+               "record,sequence,time,path,depth,processes,cpu,memory_kb\n"
+               "record,sequence,time,tid,pid,cpu,name\n", out_);
+    header_ = true;
+  }
+  MemInfo const& memory = sample.meminfo;
+  IoRates const& io = sample.io;
+  std::fprintf(out_, "system,%lu,%lld,%.4f,%.4f,%d,%d,%ld,%.4f,%d,%d,%.4f,%llu,%llu,%llu,%llu,%.0f,%.0f,%.0f,%.0f\n",
+               sample.sequence,
+               sample.time, sample.cpu, sample.memory, sample.total_processes, sample.running_processes,
+               sample.uptime, sample.self_cpu, sample.cold_period, sample.backoff, sample.swap, memory.available,
+               memory.cached + memory.buffers, memory.slab_reclaimable + memory.slab_unreclaimable,
+               memory.swap_total - std::min(memory.swap_free, memory.swap_total), io.disk_read, io.disk_write,
+               io.net_receive, io.net_send);
+  ProcessTable const& processes = sample.processes;
+  for (std::size_t i = 0; i < processes.Size(); ++i) {
+    std::fprintf(out_, "process,%lu,%lld,%d,%d,", sample.sequence, sample.time, processes.pid[i], processes.uid[i]);
+    CsvString(processes.User(i));
+    std::fprintf(out_, ",%.4f,%ld,%ld,%ld,%.0f,%.0f,%.0f,%ld,", processes.cpu[i], processes.rss_kb[i],
+                 processes.pss_kb[i], processes.uss_kb[i], processes.read_rate[i], processes.write_rate[i],
+                 processes.syscall_rate[i], processes.uptime[i]);
+    CsvString(processes.Command(i));
+    std::fputc('\n', out_);
+  }
+  for (Instrument::Summary const& timing : sample.timings) {
+    std::fprintf(out_, "timing,%lu,%lld,%s,%llu,%.1f,%.1f,%.1f,%.1f\n", sample.sequence, sample.time,
+                 timing.name, timing.count, timing.last, timing.mean, timing.p50, timing.p99);
+  }
+  for (CgroupUsage const& cgroup : sample.cgroups) {
+    std::fprintf(out_, "cgroup,%lu,%lld,", sample.sequence, sample.time);
+    CsvString(cgroup.path);
+    std::fprintf(out_, ",%d,%d,%.4f,%ld\n", cgroup.depth, cgroup.processes, cgroup.cpu, cgroup.memory_kb);
+  }
+  for (ThreadUsage const& thread : sample.threads) {
+    std::fprintf(out_, "thread,%lu,%lld,%d,%d,%.4f,", sample.sequence, sample.time, thread.tid, thread.pid,
+                 thread.cpu);
+    CsvString(thread.name);
+    std::fputc('\n', out_);
+  }
+}
+
+// Append the raw bytes of a value, the format is little endian like the host
+template <typename T>
+static void Append(std::vector<char>& record, T value) {
+  char bytes[sizeof(T)];
+  std::memcpy(bytes, &value, sizeof(T));
+  record.insert(record.end(), bytes, bytes + sizeof(T));
+}
+
+static void AppendString(std::vector<char>& record, string_view text) {
+  std::uint16_t length = text.size() > 0xffff ? 0xffff : text.size();
+  Append(record, length);
+  record.insert(record.end(), text.data(), text.data() + length);
+}
+
+// Stream header: "MONB" u16 version
+// Record per sample:
+//   u32 length of the rest of the record
+//   u64 sequence, i64 time [ms], f32 cpu, f32 memory,
+//   i32 total processes, i32 running processes, i64 uptime [s],
+//   u16 cores, f32 core utilization[cores],
+//   u32 processes, then per process:
+//     i32 pid, i32 uid, f32 cpu, i64 ram [kB], i64 pss [kB], i64 uss [kB] (-1 unknown),
+//     f32 read [B/s], f32 write [B/s], f32 syscalls [1/s] (-1 unknown), i64 uptime [s],
+//     u16 length + user bytes, u16 length + command bytes
+//   u16 stages, then per stage of the monitor's own timings:
+//     u16 length + name bytes, u64 count,
+//     f32 last, f32 mean, f32 p50, f32 p99 [us]
+//   f32 CPU use of the monitor, u16 cold period [ticks], u16 interval backoff
+//   u32 cgroups, then per cgroup in depth first order:
+//     u16 length + path bytes, u16 depth, i32 processes, f32 cpu, i64 memory [kB]
+//   f32 swap utilization, then u64 [kB] of meminfo: total, free, available, buffers,
+//     cached, shmem, slab reclaimable, slab unreclaimable, swap total, swap free
+//   f32 [B/s] disk read, disk write, network receive, network send
+//   u16 threads, then per thread by CPU: i32 tid, i32 pid, f32 cpu, u16 length + name bytes
+// The record is assembled in a reused buffer and written with one fwrite
+void StreamWriter::WriteBinary(Sample const& sample) {
+  if (!header_) {
+    std::fwrite("MONB", 1, 4, out_);
+    std::uint16_t version = 7;
+    std::fwrite(&version, sizeof(version), 1, out_);
+    header_ = true;
+  }
+  record_.clear();
+  Append(record_, std::uint32_t(0));
+  Append(record_, std::uint64_t(sample.sequence));
+  Append(record_, std::int64_t(sample.time));
+  Append(record_, sample.cpu);
+  Append(record_, sample.memory);
+  Append(record_, std::int32_t(sample.total_processes));
+  Append(record_, std::int32_t(sample.running_processes));
+  Append(record_, std::int64_t(sample.uptime));
+  Append(record_, std::uint16_t(sample.cores.size()));
+  for (float core : sample.cores) { Append(record_, core); }
+  ProcessTable const& processes = sample.processes;
+  Append(record_, std::uint32_t(processes.Size()));
+  for (std::size_t i = 0; i < processes.Size(); ++i) {
+    Append(record_, std::int32_t(processes.pid[i]));
+    Append(record_, std::int32_t(processes.uid[i]));
+    Append(record_, processes.cpu[i]);
+    Append(record_, std::int64_t(processes.rss_kb[i]));
+    Append(record_, std::int64_t(processes.pss_kb[i]));
+    Append(record_, std::int64_t(processes.uss_kb[i]));
+    Append(record_, processes.read_rate[i]);
+    Append(record_, processes.write_rate[i]);
+    Append(record_, processes.syscall_rate[i]);
+    Append(record_, std::int64_t(processes.uptime[i]));
+    AppendString(record_, processes.User(i));
+    AppendString(record_, processes.Command(i));
+  }
+  Append(record_, std::uint16_t(sample.timings.size()));
+  for (Instrument::Summary const& timing : sample.timings) {
+    AppendString(record_, timing.name);
+    Append(record_, std::uint64_t(timing.count));
+    Append(record_, float(timing.last));
+    Append(record_, float(timing.mean));
+    Append(record_, float(timing.p50));
+    Append(record_, float(timing.p99));
+  }
+  Append(record_, sample.self_cpu);
+  Append(record_, std::uint16_t(sample.cold_period));
+  Append(record_, std::uint16_t(sample.backoff));
+  Append(record_, std::uint32_t(sample.cgroups.size()));
+  for (CgroupUsage const& cgroup : sample.cgroups) {
+    AppendString(record_, cgroup.path);
+    Append(record_, std::uint16_t(cgroup.depth));
+    Append(record_, std::int32_t(cgroup.processes));
+    Append(record_, cgroup.cpu);
+    Append(record_, std::int64_t(cgroup.memory_kb));
+  }
+  Append(record_, sample.swap);
+  MemInfo const& memory = sample.meminfo;
+  for (unsigned long long value : {memory.total, memory.free, memory.available, memory.buffers, memory.cached,
+                                   memory.shmem, memory.slab_reclaimable, memory.slab_unreclaimable,
+                                   memory.swap_total, memory.swap_free}) {
+    Append(record_, std::uint64_t(value));
+  }
+  for (float rate : {sample.io.disk_read, sample.io.disk_write, sample.io.net_receive, sample.io.net_send}) {
+    Append(record_, rate);
+  }
+  Append(record_, std::uint16_t(sample.threads.size()));
+  for (ThreadUsage const& thread : sample.threads) {
+    Append(record_, std::int32_t(thread.tid));
+    Append(record_, std::int32_t(thread.pid));
+    Append(record_, thread.cpu);
+    AppendString(record_, thread.name);
+  }
+  std::uint32_t length = record_.size() - sizeof(std::uint32_t);
+  std::memcpy(record_.data(), &length, sizeof(length));
+  std::fwrite(record_.data(), 1, record_.size(), out_);
+}
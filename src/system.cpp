@@ -1,53 +1,340 @@
 #include <unistd.h>
+#include <algorithm>
 #include <cstddef>
-#include <set>
+#include <memory>
 #include <string>
+#include <unordered_set>
 #include <vector>
 
-#include "process.h"
+#include "instrument.h"
+#include "ranking.h"
+#include "process_table.h"
 #include "processor.h"
 #include "system.h"
 #include "linux_parser.h"
 
-using std::set;
 using std::size_t;
 using std::string;
 using std::vector;
 
+// Constructor reads the static system info once
+System::System(int threads, bool events, double budget, int smaps, int fds, bool uring)
+    : pool_(threads), pids_(events), budget_(budget), cgroups_(LinuxParser::CgroupDirectory()), smaps_(smaps), kernel_(LinuxParser::Kernel()), os_(LinuxParser::OperatingSystem()),
+      fd_limit_(FdCache::Reserve(2 * std::size_t(fds)) / 2),
+      stat_fds_(LinuxParser::kStatFilename, fd_limit_), io_fds_(LinuxParser::kIoFilename, fd_limit_) {
+  if (uring) { uring_ = std::make_unique<UringReader>(); }
+  Refresh();
+}
+
+// Take a new snapshot of the system wide files, then update the processes from it
+void System::Refresh() {
+  {
+    Instrument::Span span(Instrument::Stage::kSystem);
+    snapshot_.Refresh();
+    users_.Refresh();
+    cpu_.Update(snapshot_);
+    UpdateIo();
+  }
+  UpdateProcesses();
+  if (smaps_ > 0) {
+    Instrument::Span span(Instrument::Stage::kSmaps);
+    UpdateSmaps();
+  }
+  int thread_processes = thread_processes_.load(std::memory_order_relaxed);
+  if (thread_processes > 0 || tasks_.Size() > 0) {
+    Instrument::Span span(Instrument::Stage::kThreads);
+    vector<size_t> top;
+    Ranking::Top(processes_, Ranking::Key::kCpu, thread_processes, top);
+    vector<int> pids;
+    for (size_t row : top) { pids.emplace_back(processes_.pid[row]); }
+    // the pid picked in the display, unless it is among them anyway
+    int followed = followed_.load(std::memory_order_relaxed);
+    if (thread_processes > 0 && followed > 0 && processes_.Find(followed) < processes_.Size() &&
+        std::find(pids.begin(), pids.end(), followed) == pids.end()) {
+      pids.emplace_back(followed);
+    }
+    tasks_.Update(pids, snapshot_.UpTime(), pool_);
+  }
+  {
+    Instrument::Span span(Instrument::Stage::kCgroups);
+    cgroups_.Refresh(snapshot_.UpTime());
+  }
+  budget_.Update();
+}
+
+// A rate stays 0 until there are two samples
+void System::UpdateIo() {
+  IoTotals const& totals = snapshot_.Io();
+  double time = snapshot_.UpTime();
+  auto rate = [time](DeltaCounter& counter, unsigned long long value, float& result) {
+    double per_second{0.0};
+    result = counter.Update(value, time, per_second) ? per_second : 0.0f;
+  };
+  rate(disk_read_, totals.disk_read, io_.disk_read);
+  rate(disk_write_, totals.disk_written, io_.disk_write);
+  rate(net_receive_, totals.net_received, io_.net_receive);
+  rate(net_send_, totals.net_sent, io_.net_send);
+}
+
 // Return the system's CPU
 Processor& System::Cpu() { return cpu_; }
 
 // Return a container composed of the system's processes
-vector<Process>& System::Processes() { 
-  //remove all previous items from the vector
-  processes_.clear();
+ProcessTable const& System::Processes() { return processes_; }
+
+// Return the CPU use of the monitor and the schedule it led to
+Budget const& System::CpuBudget() { return budget_; }
+
+// Return the cgroups of the processes
+CgroupTree const& System::Cgroups() { return cgroups_; }
+
+void System::ScanThreads(int processes) { thread_processes_.store(processes, std::memory_order_relaxed); }
+
+void System::FollowThreads(int pid) { followed_.store(pid, std::memory_order_relaxed); }
+
+// Return the threads of the followed processes
+TaskScanner const& System::Threads() { return tasks_; }
+
+// Processes read every tick no matter the budget, by CPU of the previous read
+static const std::size_t kHotProcesses{64};
+// Ticks a PSS/USS read stays valid, smaps_rollup walks all mappings of a process
+static const unsigned long kSmapsPeriod{5};
+// Ticks between two reads of the io file of a process that did not run
+static const unsigned long kIoPeriod{4};
+
+// I/O rates of a row, -1 if the file can not be read (another user's process)
+static void StoreIo(ProcessTable& table, size_t row, std::string_view text, double uptime) {
+  ProcParser::PidIo io;
+  if (ProcParser::ParsePidIo(text, io)) {
+    table.StoreIo(row, io, uptime);
+  } else {
+    table.read_rate[row] = table.write_rate[row] = table.syscall_rate[row] = -1.0f;
+  }
+}
+
+// Re-read the counters that change between ticks, false if the process
+// exited or its pid now belongs to another process (different start time)
+// user and command stay interned for the lifetime of the row
+// the rss comes from stat as well, so a row costs one file plus io when the
+// process ran: one that used no CPU time did little I/O, its rates show 0
+// and the next periodic read averages over the whole span
+// io_due tells whether the io file has to be read as well
+static bool StoreStat(ProcessTable& table, size_t row, std::string_view text, double uptime, unsigned long tick,
+                      bool& io_due) {
+  ProcParser::PidStat stat;
+  if (!ProcParser::ParsePidStat(text, stat) || stat.start_time != table.start_time[row]) { return false; }
+  bool ran = stat.utime + stat.stime != table.utime[row] + table.stime[row];
+  table.Store(row, stat, stat.rss * ProcessTable::PageKb(), uptime);
+  io_due = ran || (tick + table.pid[row]) % kIoPeriod == 0;
+  if (!io_due && table.read_rate[row] >= 0.0f) {
+    table.read_rate[row] = table.write_rate[row] = table.syscall_rate[row] = 0.0f;
+  }
+  return true;
+}
+
+// both files are read through descriptors kept open across ticks
+static bool RefreshRow(ProcessTable& table, FdCache& stat_fds, FdCache& io_fds, size_t row, double uptime,
+                       unsigned long tick) {
+  bool io_due = false;
+  if (!StoreStat(table, row, stat_fds.Read(row, table.pid[row]), uptime, tick, io_due)) { return false; }
+  if (io_due) { StoreIo(table, row, io_fds.Read(row, table.pid[row]), uptime); }
+  return true;
+}
+
+// The same as RefreshRow over many rows, with the files read in batches
+// through the ring and only the parsing spread over the pool
+void System::RefreshRows(vector<size_t> const& rows, double uptime, vector<char>& keep) {
+  vector<std::string_view> texts;
+  stat_fds_.ReadBatch(*uring_, rows, processes_.pid, texts);
+  vector<char> io_due(rows.size(), 0);
+  pool_.Run(rows.size(), [&](size_t begin, size_t end, int) {
+    for (size_t k = begin; k < end; ++k) {
+      bool due = false;
+      keep[rows[k]] = StoreStat(processes_, rows[k], texts[k], uptime, tick_, due);
+      io_due[k] = due;
+    }
+  });
 
+  vector<size_t> io_rows;
+  for (size_t k = 0; k < rows.size(); ++k) {
+    if (io_due[k]) { io_rows.push_back(rows[k]); }
+  }
+  io_fds_.ReadBatch(*uring_, io_rows, processes_.pid, texts);
+  pool_.Run(io_rows.size(), [&](size_t begin, size_t end, int) {
+    for (size_t k = begin; k < end; ++k) { StoreIo(processes_, io_rows[k], texts[k], uptime); }
+  });
+}
+
+// processes_ persists across ticks: known processes only refresh their
+// counters, exited ones are evicted and new pids are added
+// reading the files is spread over the scan pool, every worker writes
+// only to its own rows and buffers, the merge afterwards is serial
+void System::UpdateProcesses() {
   //get all Pids
-  std::vector<int> all_pids = LinuxParser::Pids();
+  vector<int> all_pids;
+  vector<int> exec;
+  vector<int> forked;
+  {
+    Instrument::Span span(Instrument::Stage::kPids);
+    pids_.Update(all_pids, exec, forked);
+  }
+  double uptime = snapshot_.UpTime();
+
+  std::unordered_set<int> known;
+  {
+    Instrument::Span span(Instrument::Stage::kUpdate);
+    std::unordered_set<int> alive(all_pids.begin(), all_pids.end());
+
+    // under a tight budget only the hot rows are read every tick, the others
+    // once per cold period, staggered by pid; in between nothing of them is
+    // read, they keep the values of their last read and only their age moves
+    // on. A pid reused meanwhile is caught by the start time on the next read,
+    // or at once with events, where a fork or exec of a pid makes it due
+    int period = budget_.ColdPeriod();
+    vector<char> hot;
+    if (period > 1) {
+      vector<size_t> top;
+      Ranking::Top(processes_, Ranking::Key::kCpu, kHotProcesses, top);
+      hot.assign(processes_.Size(), 0);
+      for (size_t row : top) { hot[row] = 1; }
+    }
+    ++tick_;
+    vector<char> keep(processes_.Size(), 0);
+    std::unordered_set<int> seen(forked.begin(), forked.end());
+    seen.insert(exec.begin(), exec.end());
+    auto due = [&](size_t i) {
+      int pid = processes_.pid[i];
+      if (alive.count(pid) == 0) { return false; }
+      if (period > 1 && !hot[i] && (tick_ + pid) % period != 0 && seen.count(pid) == 0) {
+        processes_.uptime[i] = uptime - processes_.start_time[i] / ProcessTable::Hertz();
+        keep[i] = 1;
+        return false;
+      }
+      return true;
+    };
 
-  // populate vector processes
-  for (int pid : all_pids) { processes_.emplace_back(pid); } 
+    // update the known rows in parallel, or in batches through the ring
+    if (uring_ && uring_->Available()) {
+      vector<size_t> rows;
+      for (size_t i = 0; i < processes_.Size(); ++i) {
+        if (due(i)) { rows.push_back(i); }
+      }
+      RefreshRows(rows, uptime, keep);
+    } else {
+      pool_.Run(processes_.Size(), [&](size_t begin, size_t end, int) {
+        for (size_t i = begin; i < end; ++i) {
+          if (due(i)) { keep[i] = RefreshRow(processes_, stat_fds_, io_fds_, i, uptime, tick_); }
+        }
+      });
+    }
 
-  // sort the vector by operator overloading 
-  std::sort(processes_.begin(), processes_.end());
-  
-  return processes_;
+    // drop exited and reused pids
+    for (size_t row = 0; row < processes_.Size(); ++row) {
+      if (!keep[row]) { cgroups_.Remove(processes_.Cgroup(row)); }
+    }
+    processes_.Keep(keep);
+    stat_fds_.Keep(keep);
+    io_fds_.Keep(keep);
+    stat_fds_.Trim();
+    io_fds_.Trim();
+    known.insert(processes_.pid.begin(), processes_.pid.end());
+
+    // a process that exec'd keeps its pid and start time but runs a new command
+    if (!exec.empty()) {
+      std::unordered_set<int> changed(exec.begin(), exec.end());
+      for (size_t row = 0; row < processes_.Size(); ++row) {
+        if (changed.count(processes_.pid[row]) != 0) {
+          processes_.SetCommand(row, LinuxParser::Command(processes_.pid[row]));
+        }
+      }
+    }
+  }
+
+  // read the processes started since the last tick into per worker buffers
+  Instrument::Span span(Instrument::Stage::kNew);
+  struct Started {
+    int pid;
+    int uid;
+    string command;
+    string cgroup;
+    ProcParser::PidStat stat;
+    ProcParser::PidIo io;
+    bool has_io;
+  };
+  vector<int> started;
+  for (int pid : all_pids) {
+    if (known.count(pid) == 0) { started.emplace_back(pid); }
+  }
+  vector<vector<Started>> buffers(pool_.Size());
+  pool_.Run(started.size(), [&](size_t begin, size_t end, int worker) {
+    for (size_t i = begin; i < end; ++i) {
+      Started process{started[i], LinuxParser::Uid(started[i]), LinuxParser::Command(started[i]),
+                      LinuxParser::Cgroup(started[i]), {}, {}, false};
+      if (!LinuxParser::Stat(process.pid, process.stat)) { continue; }
+      process.has_io = LinuxParser::Io(process.pid, process.io);
+      buffers[worker].emplace_back(std::move(process));
+    }
+  });
+  for (vector<Started>& buffer : buffers) {
+    for (Started const& process : buffer) {
+      size_t row = processes_.Add(process.pid, process.uid, users_.Name(process.uid), process.command,
+                                  process.cgroup);
+      stat_fds_.Add();
+      io_fds_.Add();
+      cgroups_.Add(process.cgroup);
+      processes_.Store(row, process.stat, process.stat.rss * ProcessTable::PageKb(), uptime);
+      if (process.has_io) { processes_.StoreIo(row, process.io, uptime); }
+    }
+  }
+  processes_.Index();
+}
+
+// PSS and USS are cached in the rows, so they leave with their process
+// a failed read is not retried before the period is over either
+void System::UpdateSmaps() {
+  vector<size_t> top;
+  Ranking::Top(processes_, Ranking::Key::kRam, smaps_, top);
+  vector<size_t> due;
+  for (size_t row : top) {
+    if (processes_.smaps_tick[row] == 0 || tick_ - processes_.smaps_tick[row] >= kSmapsPeriod) {
+      due.emplace_back(row);
+    }
+  }
+  pool_.Run(due.size(), [&](size_t begin, size_t end, int) {
+    for (size_t i = begin; i < end; ++i) {
+      size_t row = due[i];
+      long pss_kb{-1}, uss_kb{-1};
+      if (!LinuxParser::SmapsRollup(processes_.pid[row], pss_kb, uss_kb)) { pss_kb = uss_kb = -1; }
+      processes_.pss_kb[row] = pss_kb;
+      processes_.uss_kb[row] = uss_kb;
+      processes_.smaps_tick[row] = tick_;
+    }
+  });
 }
 
 // Return the system's kernel identifier (string)
-std::string System::Kernel() { return LinuxParser::Kernel(); }
+std::string System::Kernel() { return kernel_; }
 
 // Return the system's memory utilization
-float System::MemoryUtilization() { return LinuxParser::MemoryUtilization(); }
+float System::MemoryUtilization() { return snapshot_.MemoryUtilization(); }
+
+// Return the system's swap utilization
+float System::SwapUtilization() { return snapshot_.SwapUtilization(); }
+
+// Return the values of /proc/meminfo
+MemInfo const& System::Memory() { return snapshot_.Memory(); }
+
+// Return the disk and network rates
+IoRates const& System::Io() { return io_; }
 
 // Return the operating system name
-std::string System::OperatingSystem() { return LinuxParser::OperatingSystem(); }
+std::string System::OperatingSystem() { return os_; }
 
 // Return the number of processes actively running on the system
-int System::RunningProcesses() { return LinuxParser::RunningProcesses(); }
+int System::RunningProcesses() { return snapshot_.RunningProcesses(); }
 
 // Return the total number of processes on the system
-int System::TotalProcesses() { return LinuxParser::TotalProcesses(); }
+int System::TotalProcesses() { return snapshot_.TotalProcesses(); }
 
 // Return the number of seconds since the system started running
-long int System::UpTime() { return LinuxParser::UpTime();}
\ No newline at end of file
+long int System::UpTime() { return long(snapshot_.UpTime()); }
@@ -0,0 +1,201 @@
+#include <algorithm>
+#include <charconv>
+#include <string_view>
+
+#include "linux_parser.h"
+#include "system_snapshot.h"
+
+using std::string_view;
+
+// Parse the cpu times of a "cpuN" line, behind the label
+static void ParseCpuTimes(ProcParser::Scanner& scanner, CpuTimes& times) {
+  scanner.Number(times.user);
+  scanner.Number(times.nice);
+  scanner.Number(times.system);
+  scanner.Number(times.idle);
+  scanner.Number(times.iowait);
+  scanner.Number(times.irq);
+  scanner.Number(times.softirq);
+  scanner.Number(times.steal);
+}
+
+// The columns double when a core beyond them shows up, the first parse
+// and hotplug only
+std::uint64_t* CpuMatrix::Reserve(std::size_t core) {
+  if (core >= capacity_) {
+    std::size_t capacity = std::max<std::size_t>(2 * capacity_, 64);
+    std::vector<std::uint64_t> values(kFields * capacity, 0);
+    for (std::size_t field = 0; field < kFields; ++field) {
+      std::copy_n(values_.data() + field * capacity_, capacity_, values.data() + field * capacity);
+    }
+    values_.swap(values);
+    capacity_ = capacity;
+  }
+  return values_.data() + core;
+}
+
+// One pass over /proc/stat for the cpu lines and the process counters
+void SystemSnapshot::ParseStat(string_view text) {
+  std::size_t cores = 0;
+  ProcParser::Scanner scanner(text);
+  while (!scanner.Done()) {
+    string_view key = scanner.Field();
+    if (key == LinuxParser::filterCpu) {
+      ParseCpuTimes(scanner, cpu_);
+    } else if (key.substr(0, 3) == LinuxParser::filterCpu) {
+      int id{0};
+      std::from_chars(key.data() + 3, key.data() + key.size(), id);
+      if (cores == cores_.Cores()) { cores_.ids_.emplace_back(); }
+      cores_.ids_[cores] = id;
+      std::uint64_t* counters = cores_.Reserve(cores);
+      // older kernels have fewer fields
+      for (std::size_t field = 0; field < CpuMatrix::kFields; ++field) {
+        std::uint64_t& counter = counters[field * cores_.capacity_];
+        counter = 0;
+        scanner.Number(counter);
+      }
+      ++cores;
+    } else if (key == LinuxParser::filterProcesses) {
+      scanner.Number(total_processes_);
+    } else if (key == LinuxParser::filterRunningProcesses) {
+      scanner.Number(running_processes_);
+    }
+    scanner.SkipLine();
+  }
+  cores_.ids_.resize(cores);
+}
+
+// One pass over /proc/meminfo for all keys we use
+void SystemSnapshot::ParseMeminfo(string_view text) {
+  ProcParser::Scanner scanner(text);
+  while (!scanner.Done()) {
+    string_view key = scanner.Field();
+    unsigned long long* value = nullptr;
+    if (key == LinuxParser::filterMemTotalString) {
+      value = &memory_.total;
+    } else if (key == LinuxParser::filterMemFreeString) {
+      value = &memory_.free;
+    } else if (key == LinuxParser::filterMemAvailableString) {
+      value = &memory_.available;
+    } else if (key == LinuxParser::filterBufferString) {
+      value = &memory_.buffers;
+    } else if (key == LinuxParser::filterCachedString) {
+      value = &memory_.cached;
+    } else if (key == LinuxParser::filterShmemString) {
+      value = &memory_.shmem;
+    } else if (key == LinuxParser::filterSlabReclaimableString) {
+      value = &memory_.slab_reclaimable;
+    } else if (key == LinuxParser::filterSlabUnreclaimableString) {
+      value = &memory_.slab_unreclaimable;
+    } else if (key == LinuxParser::filterSwapTotalString) {
+      value = &memory_.swap_total;
+    } else if (key == LinuxParser::filterSwapFreeString) {
+      value = &memory_.swap_free;
+    }
+    if (value != nullptr) { scanner.Number(*value); }
+    scanner.SkipLine();
+  }
+}
+
+// Devices whose I/O is already counted on the disks below them
+static bool Stacked(string_view name) {
+  for (string_view prefix : {"loop", "ram", "dm-", "md"}) {
+    if (name.substr(0, prefix.size()) == prefix) { return true; }
+  }
+  return false;
+}
+
+// A disk is listed before its partitions: sda1, nvme0n1p1, mmcblk0p1
+static bool Partition(string_view name, string_view disk) {
+  if (disk.empty() || name.size() <= disk.size() || name.substr(0, disk.size()) != disk) { return false; }
+  string_view rest = name.substr(disk.size());
+  if (rest[0] == 'p' && rest.size() > 1) { rest.remove_prefix(1); }
+  return rest[0] >= '0' && rest[0] <= '9';
+}
+
+// Sectors are 512 bytes whatever the device's block size
+void SystemSnapshot::ParseDiskstats(string_view text) {
+  io_.disk_read = io_.disk_written = 0;
+  string_view disk;
+  ProcParser::Scanner scanner(text);
+  while (!scanner.Done()) {
+    // major minor name reads merged sectors ms writes merged sectors
+    scanner.SkipFields(2);
+    string_view name = scanner.Field();
+    if (name.empty() || Stacked(name) || Partition(name, disk)) {
+      scanner.SkipLine();
+      continue;
+    }
+    disk = name;
+    unsigned long long read{0}, written{0};
+    scanner.SkipFields(2);
+    scanner.Number(read);
+    scanner.SkipFields(3);
+    scanner.Number(written);
+    io_.disk_read += read * 512;
+    io_.disk_written += written * 512;
+    scanner.SkipLine();
+  }
+}
+
+// Two header lines, then "name: rx bytes packets errs drop fifo frame compressed multicast tx bytes ..."
+// large counters may touch the colon, so the line is split there
+void SystemSnapshot::ParseNetDev(string_view text) {
+  io_.net_received = io_.net_sent = 0;
+  std::size_t pos = 0;
+  while (pos < text.size()) {
+    std::size_t end = std::min(text.find('\n', pos), text.size());
+    string_view line = text.substr(pos, end - pos);
+    pos = end + 1;
+    std::size_t colon = line.find(':');
+    if (colon == string_view::npos) { continue; }
+    ProcParser::Scanner name(line.substr(0, colon));
+    if (name.Field() == "lo") { continue; }
+    ProcParser::Scanner scanner(line.substr(colon + 1));
+    unsigned long long received{0}, sent{0};
+    scanner.Number(received);
+    scanner.SkipFields(7);
+    scanner.Number(sent);
+    io_.net_received += received;
+    io_.net_sent += sent;
+  }
+}
+
+void SystemSnapshot::Refresh() {
+  std::string const& proc = LinuxParser::ProcDirectory();
+
+  uptime_ = 0.0;
+  if (ProcParser::ReadFile(ProcParser::Path(proc, LinuxParser::kUptimeFilename).c_str(), buffer_)) {
+    ProcParser::Scanner(buffer_.View()).Number(uptime_);
+  }
+  if (ProcParser::ReadFile(ProcParser::Path(proc, LinuxParser::kStatFilename).c_str(), buffer_)) {
+    ParseStat(buffer_.View());
+  }
+  if (ProcParser::ReadFile(ProcParser::Path(proc, LinuxParser::kMeminfoFilename).c_str(), buffer_)) {
+    ParseMeminfo(buffer_.View());
+  }
+  if (ProcParser::ReadFile(ProcParser::Path(proc, LinuxParser::kDiskstatsFilename).c_str(), buffer_)) {
+    ParseDiskstats(buffer_.View());
+  }
+  if (ProcParser::ReadFile(ProcParser::Path(proc, LinuxParser::kNetDevFilename).c_str(), buffer_)) {
+    ParseNetDev(buffer_.View());
+  }
+}
+
+// (MemTotal - MemAvailable) / MemTotal, the kernel's estimate also counts
+// reclaimable slab as free and shmem as used
+// kernels before 3.14 have no MemAvailable: (MemTotal - MemFree - Buffers - Cached) / MemTotal
+float SystemSnapshot::MemoryUtilization() const {
+  if (memory_.total == 0) { return 0.0f; }
+  if (memory_.available > 0) {
+    return float(memory_.total - std::min(memory_.available, memory_.total)) / memory_.total;
+  }
+  float used = float(memory_.total) - memory_.free - memory_.buffers - memory_.cached;
+  return used / memory_.total;
+}
+
+// (SwapTotal - SwapFree) / SwapTotal, 0 without swap
+float SystemSnapshot::SwapUtilization() const {
+  if (memory_.swap_total == 0) { return 0.0f; }
+  return float(memory_.swap_total - std::min(memory_.swap_free, memory_.swap_total)) / memory_.swap_total;
+}
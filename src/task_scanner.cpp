@@ -0,0 +1,105 @@
+#include <algorithm>
+#include <unordered_map>
+
+#include "linux_parser.h"
+#include "ranking.h"
+#include "task_scanner.h"
+
+using std::size_t;
+using std::vector;
+
+// Rows and owners stay aligned
+void TaskScanner::Keep(vector<char> const& keep) {
+  size_t kept = 0;
+  for (size_t row = 0; row < owner_.size(); ++row) {
+    if (keep[row]) { owner_[kept++] = owner_[row]; }
+  }
+  owner_.resize(kept);
+  threads_.Keep(keep);
+}
+
+// Threads that exited, moved to another process or whose tid was reused
+// are dropped
+void TaskScanner::Update(vector<int> const& pids, double uptime, ScanPool& pool) {
+  std::unordered_map<int, int> listed;  // tid -> pid
+  for (int pid : pids) {
+    for (int tid : LinuxParser::Tasks(pid)) { listed.emplace(tid, pid); }
+  }
+
+  vector<char> keep(threads_.Size(), 0);
+  for (size_t row = 0; row < threads_.Size(); ++row) {
+    auto found = listed.find(threads_.pid[row]);
+    if (found == listed.end() || found->second != owner_[row]) { continue; }
+    keep[row] = 1;
+    listed.erase(found);
+  }
+  Keep(keep);
+
+  // what is left of listed are new threads, they come first
+  struct Started {
+    int pid;
+    int tid;
+    std::string name;
+    ProcParser::PidStat stat;
+  };
+  vector<Started> started;
+  for (auto const& entry : listed) {
+    if (started.size() == batch_) { break; }
+    started.push_back({entry.second, entry.first, {}, {}});
+  }
+  vector<char> found(started.size(), 0);
+  pool.Run(started.size(), [&](size_t begin, size_t end, int) {
+    for (size_t i = begin; i < end; ++i) {
+      found[i] = LinuxParser::TaskStat(started[i].pid, started[i].tid, started[i].stat);
+      if (found[i]) { started[i].name = LinuxParser::TaskName(started[i].pid, started[i].tid); }
+    }
+  });
+
+  // the rest of the batch re-reads the known rows from the cursor on
+  size_t known = threads_.Size();
+  size_t count = std::min(known, batch_ - started.size());
+  if (cursor_ >= known) { cursor_ = 0; }
+  vector<char> alive(known, 1);
+  pool.Run(count, [&](size_t begin, size_t end, int) {
+    ProcParser::PidStat stat;
+    for (size_t i = begin; i < end; ++i) {
+      size_t row = (cursor_ + i) % known;
+      if (!LinuxParser::TaskStat(owner_[row], threads_.pid[row], stat) ||
+          stat.start_time != threads_.start_time[row]) {
+        alive[row] = 0;
+        continue;
+      }
+      threads_.Store(row, stat, 0, uptime);
+    }
+  });
+  cursor_ = known == 0 ? 0 : (cursor_ + count) % known;
+  if (std::find(alive.begin(), alive.end(), 0) != alive.end()) { Keep(alive); }
+
+  for (size_t i = 0; i < started.size(); ++i) {
+    if (!found[i]) { continue; }
+    size_t row = threads_.Add(started[i].tid, -1, {}, started[i].name);
+    threads_.Store(row, started[i].stat, 0, uptime);
+    owner_.push_back(started[i].pid);
+  }
+}
+
+void TaskScanner::Top(size_t n, vector<ThreadUsage>& rows, int first_pid) const {
+  vector<size_t> top;
+  if (first_pid > 0) {
+    // all rows are ranked, an idle process's threads would be cut off otherwise
+    Ranking::Top(threads_, Ranking::Key::kCpu, threads_.Size(), top);
+    std::stable_partition(top.begin(), top.end(),
+                          [this, first_pid](size_t row) { return owner_[row] == first_pid; });
+    top.resize(std::min(n, top.size()));
+  } else {
+    Ranking::Top(threads_, Ranking::Key::kCpu, n, top);
+  }
+  rows.resize(top.size());
+  for (size_t i = 0; i < top.size(); ++i) {
+    size_t row = top[i];
+    rows[i].pid = owner_[row];
+    rows[i].tid = threads_.pid[row];
+    rows[i].cpu = threads_.cpu[row];
+    rows[i].name.assign(threads_.Command(row));
+  }
+}
@@ -0,0 +1,191 @@
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "uring_reader.h"
+
+using std::size_t;
+using std::vector;
+
+static int Setup(unsigned entries, io_uring_params* params) {
+  return syscall(__NR_io_uring_setup, entries, params);
+}
+
+static int Enter(int ring, unsigned submit, unsigned wait) {
+  return syscall(__NR_io_uring_enter, ring, submit, wait, IORING_ENTER_GETEVENTS, nullptr, 0);
+}
+
+// The three operations the sweep needs, IORING_OP_READ and the others
+// arrived in 5.6, older rings would fail every request
+static bool Supported(int ring) {
+  vector<char> memory(sizeof(io_uring_probe) + 256 * sizeof(io_uring_probe_op), 0);
+  io_uring_probe* probe = reinterpret_cast<io_uring_probe*>(memory.data());
+  if (syscall(__NR_io_uring_register, ring, IORING_REGISTER_PROBE, probe, 256) < 0) { return false; }
+  for (int op : {IORING_OP_OPENAT, IORING_OP_READ, IORING_OP_CLOSE}) {
+    if (op > probe->last_op || !(probe->ops[op].flags & IO_URING_OP_SUPPORTED)) { return false; }
+  }
+  return true;
+}
+
+static void* Map(int ring, size_t size, off_t offset) {
+  void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring, offset);
+  return memory == MAP_FAILED ? nullptr : memory;
+}
+
+// SUBMIT_ALL keeps submitting past a failed request (5.18), older kernels
+// reject the flag and get a ring without it
+UringReader::UringReader(unsigned entries) {
+  io_uring_params params;
+  std::memset(&params, 0, sizeof(params));
+  params.flags = IORING_SETUP_SUBMIT_ALL;
+  int ring = Setup(entries, &params);
+  if (ring < 0 && errno == EINVAL) {
+    std::memset(&params, 0, sizeof(params));
+    ring = Setup(entries, &params);
+  }
+  if (ring < 0) { return; }
+  if (!(params.features & IORING_FEAT_SINGLE_MMAP) || !Supported(ring)) {
+    close(ring);
+    return;
+  }
+
+  // one mapping holds both rings
+  sq_ring_size_ = std::max(params.sq_off.array + params.sq_entries * sizeof(unsigned),
+                           params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe));
+  sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+  sq_ring_ = Map(ring, sq_ring_size_, IORING_OFF_SQ_RING);
+  void* sqes = sq_ring_ ? Map(ring, sqes_size_, IORING_OFF_SQES) : nullptr;
+  if (sqes == nullptr) {
+    if (sq_ring_) { munmap(sq_ring_, sq_ring_size_); }
+    sq_ring_ = nullptr;
+    close(ring);
+    return;
+  }
+  cq_ring_ = sq_ring_;
+  sqes_ = static_cast<io_uring_sqe*>(sqes);
+
+  char* sq = static_cast<char*>(sq_ring_);
+  char* cq = static_cast<char*>(cq_ring_);
+  sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+  sq_mask_ = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+  sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+  cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+  cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+  cq_mask_ = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+  cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+  entries_ = params.sq_entries;
+  ring_ = ring;
+}
+
+UringReader::~UringReader() { Shutdown(); }
+
+void UringReader::Shutdown() {
+  if (ring_ < 0) { return; }
+  munmap(sqes_, sqes_size_);
+  munmap(sq_ring_, sq_ring_size_);
+  close(ring_);
+  ring_ = -1;
+}
+
+// One ring full at a time: queue the requests, then submit them and wait
+// for all completions in the same io_uring_enter; an interrupted or partial
+// submission is resumed. On any other error the ring is given up: requests
+// that never reached the kernel keep -ECANCELED, the ones in flight report
+// the error, and later calls find the ring unavailable
+template <typename Prepare>
+void UringReader::Submit(size_t count, Prepare prepare, vector<int>& results) {
+  results.assign(count, -ECANCELED);
+  if (ring_ < 0) { return; }
+  for (size_t first = 0; first < count; first += entries_) {
+    unsigned batch = std::min<size_t>(entries_, count - first);
+    unsigned tail = *sq_tail_;
+    for (unsigned i = 0; i < batch; ++i) {
+      unsigned index = (tail + i) & *sq_mask_;
+      io_uring_sqe& sqe = sqes_[index];
+      std::memset(&sqe, 0, sizeof(sqe));
+      prepare(sqe, first + i);
+      sqe.user_data = first + i;
+      sq_array_[index] = index;
+    }
+    __atomic_store_n(sq_tail_, tail + batch, __ATOMIC_RELEASE);
+
+    unsigned pending = batch, inflight = 0, done = 0;
+    while (done < batch) {
+      ++enters_;
+      int submitted = Enter(ring_, pending, pending + inflight);
+      if (submitted < 0) {
+        int error = errno;
+        if (error != EINTR && error != EAGAIN && error != EBUSY) {
+          // the kernel consumes the queue in order
+          for (size_t i = first; i < first + batch - pending; ++i) {
+            if (results[i] == -ECANCELED) { results[i] = -error; }
+          }
+          Shutdown();
+          return;
+        }
+        submitted = 0;
+      }
+      pending -= submitted;
+      inflight += submitted;
+      unsigned head = *cq_head_;
+      unsigned end = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+      for (; head != end; ++head) {
+        io_uring_cqe const& cqe = cqes_[head & *cq_mask_];
+        results[cqe.user_data] = cqe.res;
+        --inflight;
+        ++done;
+      }
+      __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+    }
+  }
+}
+
+void UringReader::Open(vector<ProcParser::Path> const& paths, vector<int>& results) {
+  Submit(paths.size(), [&paths](io_uring_sqe& sqe, size_t i) {
+    sqe.opcode = IORING_OP_OPENAT;
+    sqe.fd = AT_FDCWD;
+    sqe.addr = reinterpret_cast<std::uintptr_t>(paths[i].c_str());
+    sqe.open_flags = O_RDONLY | O_CLOEXEC;
+  }, results);
+}
+
+// Negative descriptors become no-ops so the results stay indexed like fds
+void UringReader::Read(vector<int> const& fds, char* arena, size_t slot, vector<int>& results) {
+  Submit(fds.size(), [&fds, arena, slot](io_uring_sqe& sqe, size_t i) {
+    if (fds[i] < 0) {
+      sqe.opcode = IORING_OP_NOP;
+      return;
+    }
+    sqe.opcode = IORING_OP_READ;
+    sqe.fd = fds[i];
+    sqe.addr = reinterpret_cast<std::uintptr_t>(arena + i * slot);
+    sqe.len = slot;
+    sqe.off = 0;
+  }, results);
+  for (size_t i = 0; i < fds.size(); ++i) {
+    if (fds[i] < 0) { results[i] = -EBADF; }
+  }
+}
+
+// A descriptor whose close never reached the ring is closed directly
+void UringReader::Close(vector<int> const& fds) {
+  vector<int> open;
+  for (int fd : fds) {
+    if (fd >= 0) { open.push_back(fd); }
+  }
+  vector<int> results;
+  Submit(open.size(), [&open](io_uring_sqe& sqe, size_t i) {
+    sqe.opcode = IORING_OP_CLOSE;
+    sqe.fd = open[i];
+  }, results);
+  for (size_t i = 0; i < open.size(); ++i) {
+    if (results[i] == -ECANCELED) { close(open[i]); }
+  }
+}
@@ -0,0 +1,81 @@
+#include <sys/stat.h>
+#include <charconv>
+#include <string>
+#include <string_view>
+
+#include "linux_parser.h"
+#include "proc_parser.h"
+#include "user_cache.h"
+
+using std::string;
+using std::string_view;
+
+// Check the modification time and parse the file again if it differs
+void UserCache::Refresh() {
+  struct stat info;
+  if (stat(LinuxParser::kPasswordPath.c_str(), &info) != 0) { return; }
+  if (loaded_ && info.st_mtim.tv_sec == mtime_.tv_sec && info.st_mtim.tv_nsec == mtime_.tv_nsec) {
+    return;
+  }
+  mtime_ = info.st_mtim;
+  loaded_ = true;
+  Load();
+}
+
+// Parse name:password:uid:... lines into the table
+void UserCache::Load() {
+  ProcParser::Buffer buffer;
+  table_.clear();
+  names_.clear();
+  if (!ProcParser::ReadFile(LinuxParser::kPasswordPath.c_str(), buffer)) { return; }
+
+  string_view text = buffer.View();
+  std::size_t lines = 0;
+  for (char c : text) { lines += c == '\n'; }
+  // keep the load factor below 0.5
+  std::size_t capacity = 16;
+  while (capacity < 2 * (lines + 1)) { capacity *= 2; }
+  table_.assign(capacity, Entry{});
+
+  while (!text.empty()) {
+    std::size_t end = text.find('\n');
+    string_view line = text.substr(0, end);
+    text = end == string_view::npos ? string_view() : text.substr(end + 1);
+
+    std::size_t name_end = line.find(':');
+    if (name_end == string_view::npos) { continue; }
+    std::size_t password_end = line.find(':', name_end + 1);
+    if (password_end == string_view::npos) { continue; }
+    int uid;
+    const char* first = line.data() + password_end + 1;
+    auto result = std::from_chars(first, line.data() + line.size(), uid);
+    if (result.ec != std::errc()) { continue; }
+    Insert(uid, string(line.substr(0, name_end)));
+  }
+}
+
+std::size_t UserCache::Slot(int uid) const {
+  // multiplicative hash, table size is a power of two
+  return (unsigned(uid) * 2654435761u) & (table_.size() - 1);
+}
+
+// The first entry for a uid wins, like getpwuid
+void UserCache::Insert(int uid, string name) {
+  for (std::size_t slot = Slot(uid);; slot = (slot + 1) & (table_.size() - 1)) {
+    if (table_[slot].uid == uid) { return; }
+    if (table_[slot].uid < 0) {
+      table_[slot] = {uid, int(names_.size())};
+      names_.emplace_back(std::move(name));
+      return;
+    }
+  }
+}
+
+string UserCache::Name(int uid) const {
+  if (uid >= 0 && !table_.empty()) {
+    for (std::size_t slot = Slot(uid); table_[slot].uid >= 0; slot = (slot + 1) & (table_.size() - 1)) {
+      if (table_[slot].uid == uid) { return names_[table_[slot].name]; }
+    }
+  }
+  return uid >= 0 ? std::to_string(uid) : string(" ");
+}
@@ -0,0 +1,50 @@
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include "instrument.h"
+
+static int failures = 0;
+
+static void Check(bool condition, const char* what) {
+  if (!condition) {
+    std::fprintf(stderr, "FAILED: %s\n", what);
+    ++failures;
+  }
+}
+
+// within the eighth of a bucket midpoint
+static bool Near(double value, double expected) { return value >= expected * 0.875 && value <= expected * 1.125; }
+
+static Instrument::Summary Summary(Instrument::Stage stage) {
+  std::vector<Instrument::Summary> summaries;
+  Instrument::Summarize(summaries);
+  return summaries[int(stage)];
+}
+
+int main() {
+  using std::chrono::microseconds;
+
+  // two samples: p50 is the smaller, p99 the larger
+  Instrument::Record(Instrument::Stage::kPids, microseconds(15));
+  Instrument::Record(Instrument::Stage::kPids, microseconds(3588));
+  Instrument::Summary pids = Summary(Instrument::Stage::kPids);
+  Check(pids.count == 2, "both samples are counted");
+  Check(Near(pids.p50, 15), "p50 of two samples is the smaller one");
+  Check(Near(pids.p99, 3588), "p99 of two samples is the larger one");
+
+  // one slow call in a hundred is p99 but not p50
+  for (int i = 0; i < 99; ++i) { Instrument::Record(Instrument::Stage::kRank, microseconds(10)); }
+  Instrument::Record(Instrument::Stage::kRank, microseconds(1000));
+  Instrument::Summary rank = Summary(Instrument::Stage::kRank);
+  Check(Near(rank.p50, 10), "p50 ignores the one slow call");
+  Check(Near(rank.p99, 10), "p99 of 100 samples is the 99th");
+  Instrument::Record(Instrument::Stage::kRank, microseconds(1000));
+  Check(Near(Summary(Instrument::Stage::kRank).p99, 1000), "two slow calls in 101 reach p99");
+
+  Instrument::Record(Instrument::Stage::kOutput, microseconds(40));
+  Instrument::Summary output = Summary(Instrument::Stage::kOutput);
+  Check(Near(output.p50, 40) && Near(output.p99, 40), "one sample is every percentile");
+  Check(Summary(Instrument::Stage::kSmaps).p99 == 0.0, "a stage without samples is 0");
+  return failures == 0 ? 0 : 1;
+}
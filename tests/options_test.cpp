@@ -0,0 +1,47 @@
+#include <cstdio>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+#include "options.h"
+
+static int failures = 0;
+
+static void Check(bool condition, const char* what) {
+  if (!condition) {
+    std::fprintf(stderr, "FAILED: %s\n", what);
+    ++failures;
+  }
+}
+
+static Options Parse(std::vector<const char*> args) {
+  args.insert(args.begin(), "monitor");
+  return Options::Parse(int(args.size()), const_cast<char**>(args.data()));
+}
+
+// Parse exits on an invalid argument, so it runs in a child with the usage silenced
+static bool Rejected(std::vector<const char*> args) {
+  pid_t pid = fork();
+  if (pid == 0) {
+    int null = open("/dev/null", O_WRONLY);
+    dup2(null, STDERR_FILENO);
+    Parse(args);
+    _exit(0);
+  }
+  int status = 0;
+  waitpid(pid, &status, 0);
+  return WIFEXITED(status) && WEXITSTATUS(status) != 0;
+}
+
+int main() {
+  Check(Parse({}).fds == 1024, "--fds defaults to 1024");
+  Check(Parse({"--fds", "0"}).fds == 0, "--fds 0 turns the cache off");
+  Check(Parse({"--fds=0"}).fds == 0, "--fds=0 turns the cache off");
+  Check(Parse({"--fds", "64"}).fds == 64, "--fds 64");
+  Check(Rejected({"--fds", "-1"}), "--fds -1 is rejected");
+  Check(Rejected({"--fds="}), "an empty --fds is rejected");
+  Check(Rejected({"--fds", "x"}), "--fds x is rejected");
+  Check(Rejected({"--interval", "0"}), "--interval 0 is still rejected");
+  return failures == 0 ? 0 : 1;
+}
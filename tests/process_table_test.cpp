@@ -0,0 +1,121 @@
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "process_filter.h"
+#include "process_table.h"
+#include "ranking.h"
+
+static int failures = 0;
+
+static void Check(bool condition, const char* what) {
+  if (!condition) {
+    std::fprintf(stderr, "FAILED: %s\n", what);
+    ++failures;
+  }
+}
+
+// pids of rows in their order
+static std::vector<int> Pids(ProcessTable const& table, std::vector<std::size_t> const& rows) {
+  std::vector<int> pids;
+  for (std::size_t row : rows) { pids.push_back(table.pid[row]); }
+  return pids;
+}
+
+// drop the rows of the given pids, like the end of a refresh
+static void Exit(ProcessTable& table, std::vector<int> const& pids) {
+  std::vector<char> keep(table.Size(), 1);
+  for (std::size_t row = 0; row < table.Size(); ++row) {
+    for (int pid : pids) {
+      if (table.pid[row] == pid) { keep[row] = 0; }
+    }
+  }
+  table.Keep(keep);
+}
+
+static void PidReuse() {
+  ProcessTable table;
+  table.Add(30, 0, "root", "init");
+  table.Add(10, 0, "root", "bash");
+  table.Add(20, 1000, "alice", "vim");
+  table.Index();
+  Check(Pids(table, table.ByPid()) == std::vector<int>{10, 20, 30}, "rows are indexed by pid");
+
+  // 10 exits and its pid comes back as another process before the next Index()
+  Exit(table, {10});
+  Check(table.Find(10) == table.Size(), "an exited pid is not found");
+  std::size_t row = table.Add(10, 1000, "alice", "top");
+  Check(table.Find(10) == row, "a new row is found before it is indexed");
+  table.Index();
+  Check(Pids(table, table.ByPid()) == std::vector<int>{10, 20, 30}, "a reused pid is indexed once");
+  Check(table.Find(10) == row && table.Command(table.Find(10)) == "top", "a reused pid finds the new row");
+  Check(table.Find(20) < table.Size() && table.Command(table.Find(20)) == "vim", "kept rows are renumbered");
+}
+
+static void UserOrder() {
+  ProcessTable table;
+  table.Add(5, 1000, "bob", "a");
+  table.Add(3, 0, "root", "b");
+  table.Add(9, 1000, "alice", "c");
+  table.Index();
+  Check(Pids(table, table.ByUser()) == std::vector<int>{9, 5, 3}, "rows are indexed by user");
+
+  Exit(table, {5});
+  table.Add(7, 1000, "bob", "d");
+  table.Add(2, 1000, "alice", "e");
+  table.Add(4, 0, "root", "f");
+  table.Index();
+  Check(Pids(table, table.ByUser()) == std::vector<int>{2, 9, 7, 3, 4}, "new rows merge by user, then pid");
+  Check(Pids(table, table.ByPid()) == std::vector<int>{2, 3, 4, 7, 9}, "new rows merge by pid");
+
+  std::vector<std::size_t> page;
+  Ranking::Page(table, Ranking::Key::kUser, table.ByUser(), 1, 3, page);
+  Check(Pids(table, page) == std::vector<int>{9, 7, 3}, "a user page is a slice of the index");
+  Ranking::Page(table, Ranking::Key::kPid, table.ByPid(), 4, 3, page);
+  Check(Pids(table, page) == std::vector<int>{9}, "the last page is cut at the end");
+}
+
+static void FilterCache() {
+  ProcessTable table;
+  table.Add(1, 0, "root", "bash");
+  table.Add(2, 1000, "alice", "vim");
+  table.Add(3, 1000, "bob", "bash");
+  table.Index();
+  StringArena::Id bash = table.CommandId(0);
+
+  ProcessFilter filter;
+  Check(filter.Set("BASH"), "a valid pattern is set");
+  std::vector<std::size_t> rows;
+  filter.Apply(table, table.ByPid(), rows);
+  Check(Pids(table, rows) == std::vector<int>{1, 3}, "the filter is case insensitive");
+  // root, bash, alice, vim, bob: the second bash is a hit
+  Check(filter.Searches() == 5, "every distinct string is searched once");
+
+  // both bash processes exit, a new one interns the string again
+  Exit(table, {1, 3});
+  std::size_t row = table.Add(4, 1000, "carol", "bash");
+  table.Index();
+  Check(table.CommandId(row) == bash, "a re-interned string keeps its id");
+  filter.Apply(table, table.ByPid(), rows);
+  Check(Pids(table, rows) == std::vector<int>{4}, "the new row matches");
+  Check(filter.Searches() == 6, "only the new user name is searched");
+
+  // a long command that exits leaves the arena mostly garbage, ids are handed out anew
+  unsigned long generation = table.Generation();
+  table.Add(5, 0, "root", std::string(128 * 1024, 'x'));
+  Exit(table, {5});
+  Check(table.Generation() != generation, "compaction starts a new generation");
+  filter.Apply(table, table.ByPid(), rows);
+  Check(Pids(table, rows) == std::vector<int>{4}, "the filter still matches after compaction");
+  Check(filter.Searches() > 6, "a new generation drops the cache");
+
+  Check(!filter.Set("("), "an invalid pattern is refused");
+  Check(filter.Pattern() == "BASH", "the previous pattern stays in effect");
+}
+
+int main() {
+  PidReuse();
+  UserOrder();
+  FilterCache();
+  return failures == 0 ? 0 : 1;
+}
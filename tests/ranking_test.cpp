@@ -0,0 +1,75 @@
+#include <cstdio>
+#include <limits>
+#include <vector>
+
+#include "process_filter.h"
+#include "process_table.h"
+#include "ranking.h"
+
+static int failures = 0;
+
+static void Check(bool condition, const char* what) {
+  if (!condition) {
+    std::fprintf(stderr, "FAILED: %s\n", what);
+    ++failures;
+  }
+}
+
+// pids 1 to count, the CPU falling with the pid, every third one run by bob
+static void Fill(ProcessTable& table, int count) {
+  for (int pid = 1; pid <= count; ++pid) {
+    std::size_t row = table.Add(pid, 0, pid % 3 == 0 ? "bob" : "alice", pid % 2 == 0 ? "even" : "odd");
+    table.cpu[row] = 1.0f - pid * 0.01f;
+  }
+  table.Index();
+}
+
+int main() {
+  std::size_t const none = std::numeric_limits<std::size_t>::max();
+  std::size_t const n = 4;
+  ProcessTable table;
+  Fill(table, 10);
+  std::vector<std::size_t> const& order = Ranking::Order(table, Ranking::Key::kPid);
+  std::vector<std::size_t> page;
+
+  Ranking::Cursor cursor = Ranking::Follow(table, Ranking::Key::kCpu, order, 0, n);
+  Check(cursor.first == 0 && cursor.selected == none && !cursor.found, "no pid is the first page");
+
+  // pid 6 is the sixth busiest, on the second page of four
+  cursor = Ranking::Follow(table, Ranking::Key::kCpu, order, 6, n);
+  Check(cursor.found && cursor.first == 4, "a followed pid opens its page");
+  Check(cursor.selected == table.Find(6), "the followed pid's row is selected");
+  Ranking::Page(table, Ranking::Key::kCpu, order, cursor.first, n, page);
+  Check(page.size() == n && table.pid[page[1]] == 6, "the page holds the followed pid");
+
+  // the first and the last position of a page
+  Check(Ranking::Follow(table, Ranking::Key::kCpu, order, 5, n).first == 4, "a page starts at a multiple of n");
+  Check(Ranking::Follow(table, Ranking::Key::kCpu, order, 4, n).first == 0, "the last row stays on its page");
+  cursor = Ranking::Follow(table, Ranking::Key::kCpu, order, 10, n);
+  Ranking::Page(table, Ranking::Key::kCpu, order, cursor.first, n, page);
+  Check(cursor.first == 8 && page.size() == 2, "the last page is short");
+
+  // the pid gets busier and moves up a page
+  table.cpu[table.Find(6)] = 2.0f;
+  cursor = Ranking::Follow(table, Ranking::Key::kCpu, order, 6, n);
+  Check(cursor.found && cursor.first == 0, "the page follows the pid");
+
+  // ascending keys go through the index
+  cursor = Ranking::Follow(table, Ranking::Key::kPid, order, 9, n);
+  Check(cursor.found && cursor.first == 8, "pid order");
+  cursor = Ranking::Follow(table, Ranking::Key::kUser, Ranking::Order(table, Ranking::Key::kUser), 3, n);
+  Check(cursor.found && cursor.first == 4, "user order: 7 alice rows, then bob");
+
+  // a filter hiding the pid, and a pid that is gone
+  ProcessFilter filter;
+  std::vector<std::size_t> listed;
+  filter.Set("^odd$");
+  filter.Apply(table, order, listed);
+  cursor = Ranking::Follow(table, Ranking::Key::kCpu, listed, 6, n);
+  Check(!cursor.found && cursor.first == 0 && cursor.selected == none, "a filtered pid is not found");
+  cursor = Ranking::Follow(table, Ranking::Key::kCpu, listed, 7, n);
+  Check(cursor.found && cursor.first == 0, "positions count the filtered rows only");
+  cursor = Ranking::Follow(table, Ranking::Key::kCpu, order, 42, n);
+  Check(!cursor.found && cursor.first == 0, "a pid not in the table is not found");
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,62 @@
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+
+#include "linux_parser.h"
+#include "system_snapshot.h"
+
+static int failures = 0;
+
+static void Check(bool condition, const char* what) {
+  if (!condition) {
+    std::fprintf(stderr, "FAILED: %s\n", what);
+    ++failures;
+  }
+}
+
+static bool Near(float value, float expected) { return std::fabs(value - expected) < 1e-5f; }
+
+// a fresh snapshot per file, keys never disappear from a live meminfo
+static float MemoryUtilization(std::string const& root, std::string const& text) {
+  std::ofstream(root + "meminfo") << text;
+  SystemSnapshot snapshot;
+  snapshot.Refresh();
+  return snapshot.MemoryUtilization();
+}
+
+int main() {
+  char directory[] = "/tmp/system_snapshot_testXXXXXX";
+  if (mkdtemp(directory) == nullptr) { return 1; }
+  std::string root = std::string(directory) + "/";
+  LinuxParser::SetProcDirectory(root);
+
+  // MemAvailable is used, free, buffers and cached only matter without it
+  Check(Near(MemoryUtilization(root,
+                               "MemTotal:        1000 kB\n"
+                               "MemFree:          100 kB\n"
+                               "MemAvailable:     600 kB\n"
+                               "Buffers:          200 kB\n"
+                               "Cached:           100 kB\n"),
+             0.4f),
+        "utilization is (MemTotal - MemAvailable) / MemTotal");
+
+  // kernels before 3.14
+  Check(Near(MemoryUtilization(root,
+                               "MemTotal:        1000 kB\n"
+                               "MemFree:          100 kB\n"
+                               "Buffers:          200 kB\n"
+                               "Cached:           100 kB\n"),
+             0.6f),
+        "without MemAvailable free, buffers and cached are free");
+
+  // MemAvailable above MemTotal must not wrap
+  Check(Near(MemoryUtilization(root, "MemTotal:        1000 kB\nMemAvailable:    1200 kB\n"), 0.0f),
+        "MemAvailable is capped at MemTotal");
+  Check(Near(MemoryUtilization(root, ""), 0.0f), "an empty meminfo is 0");
+
+  std::remove((root + "meminfo").c_str());
+  std::remove(directory);
+  return failures == 0 ? 0 : 1;
+}